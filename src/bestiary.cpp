@@ -19,10 +19,10 @@ Bestiary::Bestiary(const World &world, const L10n &l10n) {
     return a.kills > b.kills;
   });
   for (const auto &s : world.seen) {
-    seen.push_back(l10n.xlateNPC(s));
+    seen.emplace_back(l10n.xlateNPC(s));
   }
   for (const auto &c : world.chats) {
-    chats.push_back(l10n.xlateNPC(c));
+    chats.emplace_back(l10n.xlateNPC(c));
   }
 }
 
@@ -0,0 +1,90 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "census.h"
+#include "pool.h"
+#include "world.h"
+#include <algorithm>
+
+const char *Census::bandName(int band) {
+  static const char *names[] = {"Sky", "Surface", "Underground", "Cavern", "Underworld"};
+  return band >= 0 && band < NumBands ? names[band] : "";
+}
+
+void Census::Histogram::merge(const Histogram &other) {
+  for (size_t i = 0; i < tiles.size(); i++) {
+    tiles[i] += other.tiles[i];
+  }
+  for (size_t i = 0; i < walls.size(); i++) {
+    walls[i] += other.walls[i];
+  }
+  for (int i = 0; i < 4; i++) {
+    liquids[i] += other.liquids[i];
+  }
+  paintedTiles += other.paintedTiles;
+  paintedWalls += other.paintedWalls;
+}
+
+void Census::build(const World &world, int groundLevel, int rockLevel, int hellLevel, Pool &pool) {
+  const int wide = world.tilesWide;
+  const int high = world.tilesHigh;
+  // terraria counts the top 35% of the surface as space
+  const int tops[NumBands + 1] = {
+    0,
+    std::clamp(static_cast<int>(groundLevel * 0.35), 0, high),
+    std::clamp(groundLevel, 0, high),
+    std::clamp(rockLevel, 0, high),
+    std::clamp(hellLevel, 0, high),
+    high,
+  };
+
+  // one job per thread, so each histogram belongs to a single worker
+  int jobs = pool.size();
+  std::vector<Histogram> partial(jobs * NumBands);
+  for (int job = 0; job < jobs; job++) {
+    pool.add([&, job]() {
+      Histogram *local = partial.data() + job * NumBands;
+      for (int band = 0; band < NumBands; band++) {
+        local[band].tiles.assign(world.info.tiles.size(), 0);
+        local[band].walls.assign(world.info.walls.size(), 0);
+      }
+      int start = static_cast<int64_t>(high) * job / jobs;
+      int end = static_cast<int64_t>(high) * (job + 1) / jobs;
+      int band = 0;
+      for (int y = start; y < end; y++) {
+        while (y >= tops[band + 1] && band < NumBands - 1) {
+          band++;
+        }
+        auto &h = local[band];
+        const Tile *row = world.tiles + static_cast<size_t>(y) * wide;
+        for (int x = 0; x < wide; x++) {
+          const auto &tile = row[x];
+          if (tile.active() && tile.type >= 0 && tile.type < h.tiles.size()) {
+            h.tiles[tile.type]++;
+            if (tile.paint) {
+              h.paintedTiles++;
+            }
+          }
+          if (tile.wall > 0 && tile.wall < h.walls.size()) {
+            h.walls[tile.wall]++;
+            if (tile.wallPaint) {
+              h.paintedWalls++;
+            }
+          }
+          if (tile.liquid > 0) {
+            h.liquids[tile.shimmer() ? 3 : tile.honey() ? 2 : tile.lava() ? 1 : 0] += tile.liquid;
+          }
+        }
+      }
+    });
+  }
+  pool.wait();
+
+  for (int band = 0; band < NumBands; band++) {
+    bands[band] = Histogram();
+    bands[band].tiles.assign(world.info.tiles.size(), 0);
+    bands[band].walls.assign(world.info.walls.size(), 0);
+    for (int job = 0; job < jobs; job++) {
+      bands[band].merge(partial[job * NumBands + band]);
+    }
+  }
+}
@@ -0,0 +1,34 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class World;
+class Pool;
+
+/*
+ * How much of every block, wall and liquid the world has, split up by
+ * depth.  Each worker keeps its own histograms which are merged once
+ * they're all done.
+ */
+class Census {
+  public:
+    enum Band {
+      Sky, Surface, Underground, Cavern, Underworld, NumBands,
+    };
+    static const char *bandName(int band);
+
+    struct Histogram {
+      std::vector<uint64_t> tiles;  // by tile type
+      std::vector<uint64_t> walls;  // by wall type
+      uint64_t liquids[4] = {};  // water, lava, honey, shimmer, in 255ths of a tile
+      uint64_t paintedTiles = 0, paintedWalls = 0;
+      void merge(const Histogram &other);
+    };
+
+    void build(const World &world, int groundLevel, int rockLevel, int hellLevel, Pool &pool);
+
+    Histogram bands[NumBands];
+};
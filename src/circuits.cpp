@@ -0,0 +1,248 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "circuits.h"
+#include "pool.h"
+#include "world.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+enum Side {
+  Up, Right, Down, Left,
+};
+
+// which sides of a junction box the second half connects, by style
+// straight through, turning left, and turning right
+static const bool secondHalf[3][4] = {
+  {true, false, true, false},
+  {false, true, true, false},
+  {false, false, true, true},
+};
+
+static const uint16_t wireBits[Circuits::NumColors] = {
+  IsRedWire, IsBlueWire, IsGreenWire, IsYellowWire,
+};
+
+void Circuits::build(const World &world, Pool &pool) {
+  wide = world.tilesWide;
+  const int high = world.tilesHigh;
+  int jobs = pool.size() * 4;
+  std::vector<int> bands(jobs + 1);
+  for (int job = 0; job <= jobs; job++) {
+    bands[job] = static_cast<int64_t>(high) * job / jobs;
+  }
+
+  // each band finds its own wires, appending them in band order keeps them sorted
+  std::vector<std::array<std::vector<uint32_t>, NumColors>> found(jobs);
+  for (int job = 0; job < jobs; job++) {
+    pool.add([&, job]() {
+      for (int y = bands[job]; y < bands[job + 1]; y++) {
+        uint32_t offset = y * wide;
+        for (int x = 0; x < wide; x++, offset++) {
+          auto is = world.tiles[offset].Is();
+          for (int c = 0; c < NumColors; c++) {
+            if (is & wireBits[c]) {
+              found[job][c].push_back(offset);
+            }
+          }
+        }
+      }
+    });
+  }
+  pool.wait();
+
+  // where each band starts in every network
+  std::vector<std::array<size_t, NumColors>> firsts(jobs + 1);
+  for (int c = 0; c < NumColors; c++) {
+    auto &net = networks[c];
+    net.offsets.clear();
+    net.junctions.clear();
+    for (int job = 0; job < jobs; job++) {
+      firsts[job][c] = net.offsets.size();
+      net.offsets.insert(net.offsets.end(), found[job][c].begin(), found[job][c].end());
+    }
+    firsts[jobs][c] = net.offsets.size();
+    net.styles.assign(net.offsets.size(), 0);
+    for (uint32_t i = 0; i < net.offsets.size(); i++) {
+      const auto &tile = world.tiles[net.offsets[i]];
+      if (tile.active() && tile.type == TileJunction) {
+        net.junctions.push_back(i);
+        net.styles[i] = std::clamp(tile.u / 18, 0, 2) + 1;
+      }
+    }
+    // labels start out as the union-find's parents
+    net.labels.resize(net.offsets.size() + net.junctions.size());
+    std::iota(net.labels.begin(), net.labels.end(), 0);
+  }
+  found.clear();
+
+  // a band only joins nodes inside itself, so they can all run at once
+  for (int job = 0; job < jobs; job++) {
+    for (int c = 0; c < NumColors; c++) {
+      pool.add([&, job, c]() {
+        join(networks[c], firsts[job][c], firsts[job + 1][c]);
+      });
+    }
+  }
+  pool.wait();
+  // then each pair of rows where bands meet
+  for (int c = 0; c < NumColors; c++) {
+    auto &net = networks[c];
+    for (int job = 1; job < jobs; job++) {
+      uint32_t top = std::max(bands[job] - 1, 0) * wide;
+      uint32_t bottom = (bands[job] + 1) * wide;
+      size_t first = std::lower_bound(net.offsets.begin(), net.offsets.end(), top) - net.offsets.begin();
+      size_t last = std::lower_bound(net.offsets.begin(), net.offsets.end(), bottom) - net.offsets.begin();
+      join(net, first, last);
+    }
+    // parents always come before their children, so one pass finds every root
+    net.circuits = 0;
+    for (uint32_t i = 0; i < net.labels.size(); i++) {
+      if (net.labels[i] == i) {
+        net.circuits++;
+      } else {
+        net.labels[i] = net.labels[net.labels[i]];
+      }
+    }
+  }
+}
+
+// joins touching wires among nodes [first, last), which must be whole rows
+void Circuits::join(Network &net, size_t first, size_t last) {
+  auto &parent = net.labels;
+  auto find = [&parent](uint32_t a) {
+    while (parent[a] != a) {
+      parent[a] = parent[parent[a]];
+      a = parent[a];
+    }
+    return a;
+  };
+  // the smaller root always wins, which keeps parents ahead of children
+  auto unite = [&](uint32_t a, uint32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a < b) {
+      parent[b] = a;
+    } else if (b < a) {
+      parent[a] = b;
+    }
+  };
+  const auto &offsets = net.offsets;
+  size_t above = first, aboveEnd = first;
+  size_t i = first;
+  while (i < last) {
+    uint32_t y = offsets[i] / wide;
+    size_t rowEnd = i;
+    while (rowEnd < last && offsets[rowEnd] / wide == y) {
+      rowEnd++;
+    }
+    for (size_t j = i; j + 1 < rowEnd; j++) {
+      if (offsets[j] + 1 == offsets[j + 1]) {
+        unite(node(net, j, Right), node(net, j + 1, Left));
+      }
+    }
+    if (aboveEnd > above && offsets[above] / wide == y - 1) {
+      size_t a = above;
+      for (size_t j = i; j < rowEnd; j++) {
+        uint32_t up = offsets[j] - wide;
+        while (a < aboveEnd && offsets[a] < up) {
+          a++;
+        }
+        if (a < aboveEnd && offsets[a] == up) {
+          unite(node(net, a, Down), node(net, j, Up));
+        }
+      }
+    }
+    above = i;
+    aboveEnd = rowEnd;
+    i = rowEnd;
+  }
+}
+
+// the node for one side of a wired tile, junction boxes have two
+uint32_t Circuits::node(const Network &net, uint32_t i, int side) const {
+  if (net.styles[i] == 0 || !secondHalf[net.styles[i] - 1][side]) {
+    return i;
+  }
+  size_t k = std::lower_bound(net.junctions.begin(), net.junctions.end(), i) - net.junctions.begin();
+  return net.offsets.size() + k;
+}
+
+std::vector<Circuits::Circuit> Circuits::at(int x, int y) const {
+  std::vector<Circuit> found;
+  uint32_t offset = y * wide + x;
+  for (int c = 0; c < NumColors; c++) {
+    const auto &net = networks[c];
+    auto it = std::lower_bound(net.offsets.begin(), net.offsets.end(), offset);
+    if (it == net.offsets.end() || *it != offset) {
+      continue;
+    }
+    uint32_t i = it - net.offsets.begin();
+    found.push_back({static_cast<uint8_t>(c), net.labels[i]});
+    auto j = std::lower_bound(net.junctions.begin(), net.junctions.end(), i);
+    if (j != net.junctions.end() && *j == i) {
+      uint32_t second = net.labels[net.offsets.size() + (j - net.junctions.begin())];
+      if (second != net.labels[i]) {
+        found.push_back({static_cast<uint8_t>(c), second});
+      }
+    }
+  }
+  return found;
+}
+
+std::vector<TileIndex::Span> Circuits::tiles(const std::vector<Circuit> &circuits) const {
+  std::vector<uint32_t> offsets;
+  for (int c = 0; c < NumColors; c++) {
+    std::vector<uint32_t> ids;
+    for (const auto &circuit : circuits) {
+      if (circuit.color == c) {
+        ids.push_back(circuit.id);
+      }
+    }
+    if (ids.empty()) {
+      continue;
+    }
+    const auto &net = networks[c];
+    auto wanted = [&ids](uint32_t label) {
+      return std::find(ids.begin(), ids.end(), label) != ids.end();
+    };
+    for (uint32_t i = 0; i < net.offsets.size(); i++) {
+      if (wanted(net.labels[i])) {
+        offsets.push_back(net.offsets[i]);
+      }
+    }
+    for (size_t k = 0; k < net.junctions.size(); k++) {
+      if (wanted(net.labels[net.offsets.size() + k])) {
+        offsets.push_back(net.offsets[net.junctions[k]]);
+      }
+    }
+  }
+  // column order, to match how highlights are merged
+  std::sort(offsets.begin(), offsets.end(), [this](uint32_t a, uint32_t b) {
+    uint32_t ax = a % wide, bx = b % wide;
+    return ax < bx || (ax == bx && a < b);
+  });
+  offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+  std::vector<TileIndex::Span> spans;
+  for (auto offset : offsets) {
+    uint16_t x = offset % wide;
+    uint16_t y = offset / wide;
+    if (!spans.empty()) {
+      auto &last = spans.back();
+      if (last.x == x && last.y + last.len == y && last.len < UINT16_MAX) {
+        last.len++;
+        continue;
+      }
+    }
+    spans.push_back({x, y, 1});
+  }
+  return spans;
+}
+
+uint32_t Circuits::count() const {
+  uint32_t total = 0;
+  for (const auto &net : networks) {
+    total += net.circuits;
+  }
+  return total;
+}
@@ -0,0 +1,48 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "tileindex.h"
+#include <cstdint>
+#include <vector>
+
+class World;
+class Pool;
+
+/*
+ * Every wire network in the world, one set per wire color.  Each wired
+ * tile is a node, except junction boxes which are two, and touching wires
+ * are joined with a union-find.  Rows are split into bands that are joined
+ * in parallel, then the bands are stitched together.
+ */
+class Circuits {
+  public:
+    enum Color {
+      Red, Blue, Green, Yellow, NumColors,
+    };
+    struct Circuit {
+      uint8_t color;
+      uint32_t id;
+      bool operator==(const Circuit &other) const = default;
+    };
+    void build(const World &world, Pool &pool);
+    // the circuits running through a tile, junction boxes can be in two of each color
+    std::vector<Circuit> at(int x, int y) const;
+    // column runs sorted by x then y, the same as TileIndex
+    std::vector<TileIndex::Span> tiles(const std::vector<Circuit> &circuits) const;
+    // number of separate circuits of every color
+    uint32_t count() const;
+
+  private:
+    struct Network {
+      std::vector<uint32_t> offsets;  // of every wired tile, in row order
+      std::vector<uint32_t> junctions;  // nodes that are junction boxes, sorted
+      std::vector<uint8_t> styles;  // of every node's junction box plus one, 0 when it isn't one
+      std::vector<uint32_t> labels;  // circuit of every node, junctions' second halves come last
+      uint32_t circuits = 0;
+    };
+    void join(Network &net, size_t first, size_t last);
+    uint32_t node(const Network &net, uint32_t i, int side) const;
+    int wide = 0;
+    Network networks[NumColors];
+};
@@ -5,72 +5,168 @@
 #include <misc/cpp/imgui_stdlib.h>
 #include <algorithm>
 
-static bool contains(const std::string &haystack, const std::string &needle) {
-  auto it = std::search(
-    haystack.begin(), haystack.end(),
-    needle.begin(), needle.end(),
-    [](unsigned char ch1, unsigned char ch2) {
-      return std::tolower(ch1) == std::tolower(ch2);
-    }
-  );
-  return it != haystack.end();
-}
-
-FindChests::FindChests(const World &world, const L10n &l10n) {
-  std::unordered_map<std::string, Item> items;
+FindChests::FindChests(const World &world, const L10n &l10n, const Inventory &inventory) : l10n(l10n), inventory(inventory) {
+  std::unordered_map<std::string, Item> byName;
   search[0] = 0;
   selected = glm::vec2(0, 0);
   int i = 1;
   for (const auto &chest : world.chests) {
+    uint32_t id = chests.size();
     Chest c;
     c.name = chest.name.empty() ? "Chest #" + std::to_string(i) : chest.name;
     c.location = glm::vec2(chest.x, chest.y);
+    chests.push_back(c);
     for (const auto &item : chest.items) {
-      std::string name = l10n.xlateItem(item.name);
       // if an item is in the chest twice, without being stacked, it'll appear twice
-      if (!items[name].seen.contains(std::pair(c.location.x, c.location.y))) {
-        items[name].chests.push_back(c); 
-        items[name].seen.emplace(std::pair(c.location.x, c.location.y));
+      auto &found = byName[std::string(l10n.xlateItem(item.name))];
+      if (found.chests.empty() || found.chests.back() != id) {
+        found.chests.push_back(id);
       }
     }
     i++;
   }
-  for (auto &item : items) {
+  for (auto &item : byName) {
     item.second.name = item.first;
-    std::sort(item.second.chests.begin(), item.second.chests.end(), [](const Chest &a, const Chest &b) {
-      return a.name < b.name;
+    std::sort(item.second.chests.begin(), item.second.chests.end(), [this](uint32_t a, uint32_t b) {
+      return chests[a].name < chests[b].name;
     });
-    this->items.push_back(item.second);
+    items.push_back(std::move(item.second));
   }
-  std::sort(this->items.begin(), this->items.end(), [](const Item &a, const Item &b) {
+  std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
     return a.name < b.name;
   });
+
+  chestItems.resize(chests.size());
+  for (uint32_t id = 0; id < items.size(); id++) {
+    itemNames.add(items[id].name);
+    for (auto chest : items[id].chests) {
+      chestItems[chest].push_back(id);
+    }
+    matches.push_back({id, {}});
+  }
+  for (const auto &chest : chests) {
+    chestNames.add(chest.name);
+  }
+  closed.resize(items.size());
+  layout();
+}
+
+// items whose name matches show all their chests, otherwise an item shows
+// just the chests whose name matches
+void FindChests::filter() {
+  if (search == filtered) {
+    return;
+  }
+  matches.clear();
+  if (search.empty()) {
+    for (uint32_t id = 0; id < items.size(); id++) {
+      matches.push_back({id, {}});
+    }
+    filtered = search;
+    layout();
+    return;
+  }
+  // typing more only ever removes results, so just check what matched last time
+  if (!filtered.empty() && search.find(filtered) != std::string::npos) {
+    itemHits = itemNames.refine(itemHits, search);
+    chestHits = chestNames.refine(chestHits, search);
+  } else {
+    itemHits = itemNames.find(search);
+    chestHits = chestNames.find(search);
+  }
+  filtered = search;
+
+  std::vector<uint8_t> itemHit(items.size()), chestHit(chests.size()), candidate(items.size());
+  for (auto id : itemHits) {
+    itemHit[id] = candidate[id] = 1;
+  }
+  for (auto id : chestHits) {
+    chestHit[id] = 1;
+    for (auto item : chestItems[id]) {
+      candidate[item] = 1;
+    }
+  }
+  for (uint32_t id = 0; id < items.size(); id++) {
+    if (!candidate[id]) {
+      continue;
+    }
+    Match match{id, {}};
+    if (!itemHit[id]) {
+      for (auto chest : items[id].chests) {
+        if (chestHit[chest]) {
+          match.chests.push_back(chest);
+        }
+      }
+    }
+    matches.push_back(std::move(match));
+  }
+  layout();
+}
+
+void FindChests::layout() {
+  rows.clear();
+  for (uint32_t i = 0; i < matches.size(); i++) {
+    const auto &match = matches[i];
+    rows.push_back({i, -1});
+    if (closed[match.item]) {
+      continue;
+    }
+    int32_t num = match.chests.empty() ? items[match.item].chests.size() : match.chests.size();
+    for (int32_t j = 0; j < num; j++) {
+      rows.push_back({i, j});
+    }
+  }
 }
 
 glm::vec2 FindChests::pickChest() {
   ImGui::InputText("Search", &search);
-  ImGui::BeginChild("##chests", ImVec2(400, 400));
-  for (const auto &item : items) {
-    if (!search.empty() && !contains(item.name, search)) {
-      continue;
+  ImGui::SameLine();
+  ImGui::Checkbox("All Worlds", &allWorlds);
+  if (allWorlds) {
+    showAllWorlds();
+    if (ImGui::Button("Close")) {
+      ImGui::CloseCurrentPopup();
     }
-    if (ImGui::TreeNodeEx(item.name.c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
-      for (const auto &chest : item.chests) {
-        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf;
+    return glm::vec2(0, 0);
+  }
+  filter();
+  ImGui::BeginChild("##chests", ImVec2(400, 400));
+  bool toggled = false;
+  ImGuiListClipper clipper;
+  clipper.Begin(rows.size());
+  while (clipper.Step()) {
+    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+      const auto &row = rows[i];
+      const auto &match = matches[row.parent];
+      const auto &item = items[match.item];
+      ImGui::PushID(i);
+      if (row.child < 0) {
+        ImGui::SetNextItemOpen(!closed[match.item]);
+        bool open = ImGui::TreeNodeEx(item.name.c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen);
+        if (open == static_cast<bool>(closed[match.item])) {
+          closed[match.item] = !open;
+          toggled = true;
+        }
+      } else {
+        const auto &chest = chests[match.chests.empty() ? item.chests[row.child] : match.chests[row.child]];
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
         if (chest.location == selected) {
           flags |= ImGuiTreeNodeFlags_Selected;
         }
-        if (ImGui::TreeNodeEx(chest.name.c_str(), flags)) {
-          if (ImGui::IsItemClicked()) {
-            selected = chest.location;
-          }
-          ImGui::TreePop();
+        ImGui::Indent();
+        ImGui::TreeNodeEx(chest.name.c_str(), flags);
+        if (ImGui::IsItemClicked()) {
+          selected = chest.location;
         }
+        ImGui::Unindent();
       }
-      ImGui::TreePop();
+      ImGui::PopID();
     }
   }
   ImGui::EndChild();
+  if (toggled) {
+    layout();
+  }
   if (ImGui::Button("Cancel")) {
     ImGui::CloseCurrentPopup();
   }
@@ -81,3 +177,65 @@ glm::vec2 FindChests::pickChest() {
   }
   return selected;
 }
+
+// chests in other worlds can't be jumped to, this just shows where things are
+void FindChests::showAllWorlds() {
+  if (search != lastSearch || inventory.generation() != lastGeneration) {
+    if (search.empty()) {
+      results.clear();
+    } else {
+      results = inventory.find(search, l10n);
+    }
+    resultsClosed.assign(results.size(), 0);
+    layoutAllWorlds();
+  }
+  lastSearch = search;
+  lastGeneration = inventory.generation();
+
+  ImGui::BeginChild("##allchests", ImVec2(400, 400));
+  if (inventory.busy()) {
+    ImGui::TextDisabled("Indexing worlds...");
+  }
+  bool toggled = false;
+  ImGuiListClipper clipper;
+  clipper.Begin(resultRows.size());
+  while (clipper.Step()) {
+    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+      const auto &row = resultRows[i];
+      const auto &result = results[row.parent];
+      ImGui::PushID(i);
+      if (row.child < 0) {
+        ImGui::SetNextItemOpen(!resultsClosed[row.parent]);
+        bool open = ImGui::TreeNodeEx(result.name.c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen);
+        if (open == static_cast<bool>(resultsClosed[row.parent])) {
+          resultsClosed[row.parent] = !open;
+          toggled = true;
+        }
+      } else {
+        const auto &hit = result.hits[row.child];
+        const auto &chest = *hit.chest;
+        ImGui::Indent();
+        ImGui::BulletText("%s: %s (%d, %d)", hit.world->title.c_str(), chest.name.empty() ? "Chest" : chest.name.c_str(), chest.x, chest.y);
+        ImGui::Unindent();
+      }
+      ImGui::PopID();
+    }
+  }
+  ImGui::EndChild();
+  if (toggled) {
+    layoutAllWorlds();
+  }
+}
+
+void FindChests::layoutAllWorlds() {
+  resultRows.clear();
+  for (uint32_t i = 0; i < results.size(); i++) {
+    resultRows.push_back({i, -1});
+    if (resultsClosed[i]) {
+      continue;
+    }
+    for (int32_t j = 0; j < results[i].hits.size(); j++) {
+      resultRows.push_back({i, j});
+    }
+  }
+}
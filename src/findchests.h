@@ -4,26 +4,63 @@
 
 #include "world.h"
 #include "l10n.h"
+#include "inventory.h"
+#include "textindex.h"
 
 #include <vector>
 #include <glm/ext/vector_float2.hpp>
 
 class FindChests {
   public:
-    FindChests(const World &world, const L10n &l10n);
+    FindChests(const World &world, const L10n &l10n, const Inventory &inventory);
     glm::vec2 pickChest();
 
   private:
+    void filter();
+    void layout();
+    void showAllWorlds();
+    void layoutAllWorlds();
+
     struct Chest {
       std::string name;
       glm::vec2 location;
     };
     struct Item {
       std::string name;
-      std::vector<Chest> chests;
-      std::set<std::pair<float, float>> seen;
+      std::vector<uint32_t> chests;  // sorted by name
+    };
+    // an item that matched, and which of its chests to show
+    struct Match {
+      uint32_t item;
+      std::vector<uint32_t> chests;  // empty shows all of them
     };
     std::string search;
-    std::vector<Item> items;
+    std::vector<Chest> chests;
+    std::vector<Item> items;  // sorted by name
+    std::vector<std::vector<uint32_t>> chestItems;  // the items in each chest
     glm::vec2 selected;
+
+    // matches are only updated when the search changes
+    TextIndex itemNames, chestNames;
+    std::string filtered;
+    std::vector<uint32_t> itemHits, chestHits;
+    std::vector<Match> matches;
+
+    // one per line in the list, only the visible ones are drawn
+    struct Row {
+      uint32_t parent;
+      int32_t child;  // -1 for the parent itself
+    };
+    std::vector<Row> rows;
+    std::vector<uint8_t> closed;  // by item
+
+    // searching every world in the world folders
+    const L10n &l10n;
+    const Inventory &inventory;
+    bool allWorlds = false;
+    std::string lastSearch;
+    int lastGeneration = -1;
+    std::vector<Inventory::Result> results;
+    std::vector<Row> resultRows;
+    std::vector<uint8_t> resultsClosed;
 };
@@ -1,25 +1,33 @@
 /** @copyright 2025 Sean Kasun */
 
 #include "handle.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
-Handle::Handle(const std::string &filename) {
-  data = pos = nullptr;
+Handle::Handle(const std::string &filename, int64_t limit, int64_t start) {
+  data = pos = end = nullptr;
+  length = 0;
   std::ifstream f(filename, std::ios::in | std::ios::binary);
   if (!f.is_open()) {
     return;
   }
-  length = std::filesystem::file_size(filename);
-  data = new uint8_t[length];
-  f.read(reinterpret_cast<char*>(data), length);
+  int64_t size = std::filesystem::file_size(filename);
+  base = std::clamp<int64_t>(start, 0, size);
+  int64_t len = std::min(size - base, limit);
+  data = new uint8_t[len];
+  f.seekg(base);
+  f.read(reinterpret_cast<char*>(data), len);
   f.close();
+  length = base + len;
   pos = data;
+  end = data + len;
   alloc = true;
 }
 
 Handle::Handle(uint8_t *data, uint32_t len) : data(data), length(len) {
   pos = data;
+  end = data + len;
   alloc = false;
 }
 
@@ -34,20 +42,44 @@ bool Handle::isOpen() const {
 }
 
 int64_t Handle::tell() const {
-  return pos - data;
+  return base + (pos - data);
+}
+
+// corrupt files can ask for anything, so nothing is read past the end
+bool Handle::fits(int64_t n) {
+  if (n < 0 || n > end - pos) {
+    overrun = true;
+    pos = end;
+    return false;
+  }
+  return true;
+}
+
+int64_t Handle::remaining() const {
+  return end - pos;
 }
 
 uint8_t Handle::r8() {
+  if (pos == end) {
+    overrun = true;
+    return 0;
+  }
   return *pos++;
 }
 
 uint16_t Handle::r16() {
+  if (!fits(2)) {
+    return 0;
+  }
   uint16_t r = *pos++;
   r |= *pos++ << 8;
   return r;
 }
 
 uint32_t Handle::r32() {
+  if (!fits(4)) {
+    return 0;
+  }
   uint32_t r = *pos++;
   r |= *pos++ << 8;
   r |= *pos++ << 16;
@@ -80,6 +112,9 @@ double Handle::rd() {
 }
 
 std::string Handle::read(int len) {
+  if (!fits(len)) {
+    return "";
+  }
   std::string s(reinterpret_cast<char const *>(pos), len);
   pos += len;
   return s;
@@ -88,7 +123,7 @@ std::string Handle::read(int len) {
 std::string Handle::rcs() {
   std::string r;
   char ch;
-  while ((ch = *pos++) != 0) {
+  while ((ch = r8()) != 0) {
     r += ch;
   }
   return r;
@@ -99,11 +134,11 @@ std::string Handle::rs() {
   int shift = 0;
   uint8_t u7;
   do {
-    u7 = *pos++;
-    len |= (u7 & 0x7f) << shift;
+    u7 = r8();
+    len |= static_cast<uint32_t>(u7 & 0x7f) << shift;
     shift += 7;
-  } while (u7 & 0x80);
-  return read(len);
+  } while ((u7 & 0x80) && shift < 35);
+  return read(std::min<uint32_t>(len, INT_MAX));
 }
 
 uint8_t *Handle::readBytes(int length) {
@@ -113,9 +148,54 @@ uint8_t *Handle::readBytes(int length) {
 }
 
 void Handle::skip(int64_t length) {
-  pos += length;
+  if (fits(length)) {
+    pos += length;
+  }
 }
 
 void Handle::seek(int64_t p) {
-  pos = data + p;
+  if (p < base || p > base + (end - data)) {
+    overrun = true;
+    pos = end;
+    return;
+  }
+  pos = data + (p - base);
+}
+
+void Writer::w8(uint8_t v) {
+  data += static_cast<char>(v);
+}
+
+void Writer::w16(uint16_t v) {
+  w8(v & 0xff);
+  w8(v >> 8);
+}
+
+void Writer::w32(uint32_t v) {
+  w16(v & 0xffff);
+  w16(v >> 16);
+}
+
+void Writer::w64(uint64_t v) {
+  w32(v & 0xffffffff);
+  w32(v >> 32);
+}
+
+void Writer::wd(double v) {
+  union {
+    double d;
+    uint64_t l;
+  } dl;
+  dl.d = v;
+  w64(dl.l);
+}
+
+void Writer::ws(std::string_view s) {
+  uint32_t len = s.length();
+  do {
+    uint8_t u7 = len & 0x7f;
+    len >>= 7;
+    w8(len ? u7 | 0x80 : u7);
+  } while (len);
+  data += s;
 }
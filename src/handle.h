@@ -3,11 +3,14 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <climits>
 #include <cstdint>
 
 class Handle {
   public:
-    explicit Handle(const std::string &filename);
+    // reads at most limit bytes from start, seek and tell are still from the start of the file
+    explicit Handle(const std::string &filename, int64_t limit = INT64_MAX, int64_t start = 0);
     Handle(uint8_t *data, uint32_t len);
     ~Handle();
 
@@ -24,13 +27,34 @@ class Handle {
     std::string read(int length);
     std::string rcs();
     std::string rs();
+    // unchecked, for data that's already known to be there
     uint8_t *readBytes(int length);
     void seek(int64_t pos);
     void skip(int64_t length);
+    // bytes left before length
+    int64_t remaining() const;
 
-    int64_t length;
+    int64_t length;  // where the data we read ends, from the start of the file
+    // set once anything tries to read past length, those reads return zeros
+    bool overrun = false;
 
   private:
-    uint8_t *data, *pos;
+    bool fits(int64_t n);
+
+    uint8_t *data, *pos, *end;
+    int64_t base = 0;
     bool alloc = false;
 };
+
+// the inverse of Handle, used to build binary tables at compile time
+class Writer {
+  public:
+    void w8(uint8_t v);
+    void w16(uint16_t v);
+    void w32(uint32_t v);
+    void w64(uint64_t v);
+    void wd(double v);
+    void ws(std::string_view s);
+
+    std::string data;
+};
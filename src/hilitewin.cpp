@@ -6,21 +6,19 @@
 #include <algorithm>
 #include <memory>
 
-void lowercase(std::string &a) {
-  std::transform(a.begin(), a.end(), a.begin(), [](unsigned char c){ return std::tolower(c);});
-}
+// blocks without a parent
+const uint32_t NoParent = UINT32_MAX;
 
-HiliteWin::HiliteWin(const World &world, const L10n &l10n) {
-  for (const auto &tile : world.info.tiles) {
+HiliteWin::HiliteWin(const World &world, const L10n &l10n) : generation(l10n.generation()), world(world) {
+  for (int id = 0; id < world.info.tiles.size(); id++) {
+    const auto &tile = world.info.tiles[id];
     Block block;
-    block.tile = tile.second;
-    block.name = l10n.xlateItem(tile.second->name) + " - " + std::to_string(tile.first);
-    block.search = block.name;
-    lowercase(block.search);
-    for (const auto &child : tile.second->variants) {
-      if (child->name != tile.second->name && !child->name.empty()) {
-        block.children.push_back(addChild(child, l10n));
-        block.search += ">" + block.children.back().search;
+    block.tile = &tile;
+    block.name = l10n.xlateItem(tile.name);
+    block.name += " - " + std::to_string(id);
+    for (const auto &child : world.info.variantsOf(&tile)) {
+      if (child.name != tile.name && !child.name.empty()) {
+        block.children.push_back(addChild(world, &child, l10n));
       }
     }
     std::sort(block.children.begin(), block.children.end(), [](const Block &a, const Block &b) {
@@ -31,18 +29,28 @@ HiliteWin::HiliteWin(const World &world, const L10n &l10n) {
   std::sort(blocks.begin(), blocks.end(), [](const Block &a, const Block &b) {
               return a.name < b.name;
   });
+  // blocks don't move from here on
+  for (auto &block : blocks) {
+    index(block, NoParent);
+  }
+  layout();
 }
 
-HiliteWin::Block HiliteWin::addChild(std::shared_ptr<TileInfo> tile, const L10n &l10n) {
+void HiliteWin::index(Block &block, uint32_t parent) {
+  block.id = names.add(block.name);
+  parents.push_back(parent);
+  for (auto &child : block.children) {
+    index(child, block.id);
+  }
+}
+
+HiliteWin::Block HiliteWin::addChild(const World &world, const TileInfo *tile, const L10n &l10n) {
   Block b;
   b.tile = tile;
   b.name = l10n.xlateItem(tile->name);
-  b.search = b.name;
-  lowercase(b.search);
-  for (const auto &child : tile->variants) {
-    if (child->name != tile->name && !child->name.empty()) {
-      b.children.push_back(addChild(child, l10n));
-      b.search += ">" + b.children.back().search;
+  for (const auto &child : world.info.variantsOf(tile)) {
+    if (child.name != tile->name && !child.name.empty()) {
+      b.children.push_back(addChild(world, &child, l10n));
     }
   }
   std::sort(b.children.begin(), b.children.end(), [](const Block &a, const Block &b) {
@@ -51,19 +59,65 @@ HiliteWin::Block HiliteWin::addChild(std::shared_ptr<TileInfo> tile, const L10n
   return b;
 }
 
-std::shared_ptr<TileInfo> HiliteWin::pickBlock() {
+const TileInfo *HiliteWin::pickBlock() {
   if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && !ImGui::IsAnyItemActive() && !ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
     ImGui::SetKeyboardFocusHere(0);
   }
   ImGui::InputText("Search", &search);
+  if (search != filtered) {
+    filter();
+    layout();
+  }
   ImGui::BeginChild("##blocks", ImVec2(400, 400));
-  for (const auto &block : blocks) {
-    auto sel = pickChild(block);
-    if (sel) {
-      selection = sel;
+  bool toggled = false;
+  ImGuiListClipper clipper;
+  clipper.Begin(rows.size());
+  while (clipper.Step()) {
+    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+      const auto &row = rows[i];
+      const auto *block = row.block;
+      ImGuiTreeNodeFlags flag = ImGuiTreeNodeFlags_NoTreePushOnOpen;
+      if (block->children.size() == 0) {
+        flag |= ImGuiTreeNodeFlags_Leaf;
+      }
+      if (block->tile == selection) {
+        flag |= ImGuiTreeNodeFlags_Selected;
+      }
+      const float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+      if (indent > 0) {
+        ImGui::Indent(indent);
+      }
+      ImGui::PushID(i);
+      bool wasOpen = !closed.contains(block);
+      ImGui::SetNextItemOpen(wasOpen);
+      bool open = ImGui::TreeNodeEx(block->name.c_str(), flag);
+      if (block->children.size()) {
+        if (open != wasOpen) {
+          if (open) {
+            closed.erase(block);
+          } else {
+            closed.insert(block);
+          }
+          toggled = true;
+        }
+      } else {
+        if (ImGui::IsItemClicked()) {
+          selection = block->tile;
+        }
+        // counts come from the loaded world, we outlive it
+        ImGui::SameLine();
+        ImGui::TextDisabled("%llu", static_cast<unsigned long long>(world.blocks.count(block->tile)));
+      }
+      ImGui::PopID();
+      if (indent > 0) {
+        ImGui::Unindent(indent);
+      }
     }
   }
   ImGui::EndChild();
+  if (toggled) {
+    layout();
+  }
   if (ImGui::Button("Cancel")) {
     ImGui::CloseCurrentPopup();
   }
@@ -75,41 +129,39 @@ std::shared_ptr<TileInfo> HiliteWin::pickBlock() {
   return nullptr;
 }
 
-static bool contains(const std::string &haystack, const std::string &needle) {
-  auto it = std::search(
-    haystack.begin(), haystack.end(),
-    needle.begin(), needle.end(),
-    [](unsigned char ch1, unsigned char ch2) {
-      return std::tolower(ch1) == std::tolower(ch2);
+// a block is shown if it or any of its children match
+void HiliteWin::filter() {
+  // typing more only ever removes results, so just check what matched last time
+  if (!filtered.empty() && search.find(filtered) != std::string::npos) {
+    hits = names.refine(hits, search);
+  } else {
+    hits = names.find(search);
+  }
+  filtered = search;
+  visible.assign(parents.size(), 0);
+  for (auto id : hits) {
+    for (; id != NoParent && !visible[id]; id = parents[id]) {
+      visible[id] = 1;
     }
-  );
-  return it != haystack.end();
+  }
 }
 
-std::shared_ptr<TileInfo> HiliteWin::pickChild(const Block &block) {
-  std::shared_ptr<TileInfo> result = nullptr;
-  ImGuiTreeNodeFlags flag = ImGuiTreeNodeFlags_DefaultOpen;
-  if (!search.empty() && !contains(block.search, search)) {
-    return result;
-  }
-  if (block.children.size() == 0) {
-    flag |= ImGuiTreeNodeFlags_Leaf;
-  }
-  if (block.tile == selection) {
-    flag |= ImGuiTreeNodeFlags_Selected;
-  }
-  if (ImGui::TreeNodeEx(block.name.c_str(), flag)) {
-    if (block.children.size()) {
-      for (const auto &child : block.children) {
-        auto sel = pickChild(child);
-        if (sel) {
-          result = sel;
-        }
-      }
-    } else if (ImGui::IsItemClicked()) {
-      result = block.tile;
-    }
-    ImGui::TreePop();
+void HiliteWin::layout() {
+  rows.clear();
+  for (const auto &block : blocks) {
+    layoutChild(block, 0);
+  }
+}
+
+void HiliteWin::layoutChild(const Block &block, int depth) {
+  if (!filtered.empty() && !visible[block.id]) {
+    return;
+  }
+  rows.push_back({&block, depth});
+  if (closed.contains(&block)) {
+    return;
+  }
+  for (const auto &child : block.children) {
+    layoutChild(child, depth + 1);
   }
-  return result;
 }
@@ -4,23 +4,47 @@
 
 #include "world.h"
 #include "l10n.h"
+#include "textindex.h"
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 class HiliteWin {
   public:
     HiliteWin(const World &world, const L10n &l10n);
-    std::shared_ptr<TileInfo> pickBlock();
+    const TileInfo *pickBlock();
+    // the l10n generation our names came from
+    const int generation;
 
   private:
     struct Block {
       std::string name;
-      std::string search;
       std::vector<Block> children;
-      std::shared_ptr<TileInfo> tile;
+      const TileInfo *tile;
+      uint32_t id;  // into names and parents
     };
-    Block addChild(std::shared_ptr<TileInfo> tile, const L10n &l10n);
-    std::shared_ptr<TileInfo> pickChild(const Block &tile);
+    Block addChild(const World &world, const TileInfo *tile, const L10n &l10n);
+    void index(Block &block, uint32_t parent);
+    void filter();
+    void layout();
+    void layoutChild(const Block &block, int depth);
+    const World &world;
     std::vector<Block> blocks;
     std::string search;
-    std::shared_ptr<TileInfo> selection = nullptr;
+    const TileInfo *selection = nullptr;
+
+    // the tree flattened into lines, only the visible ones are drawn
+    struct Row {
+      const Block *block;
+      int depth;
+    };
+    std::vector<Row> rows;
+    std::unordered_set<const Block *> closed;
+
+    // every block's name, searched once per keystroke
+    TextIndex names;
+    std::vector<uint32_t> parents;
+    std::string filtered;
+    std::vector<uint32_t> hits;
+    std::vector<uint8_t> visible;  // matched, or has a child that did
 };
@@ -3,7 +3,9 @@
 #include "infowin.h"
 #include "imgui.h"
 
-InfoWin::InfoWin(const World &world) {
+#include <algorithm>
+
+InfoWin::InfoWin(const World &world, const L10n &l10n) : generation(l10n.generation()) {
   const char *on = "☑";
   const char *off = "☐";
   const auto &h = world.header;
@@ -15,7 +17,7 @@ InfoWin::InfoWin(const World &world) {
     "Master",
     "Journey",
   };
-  add("World Mode", h.is("master") ? "Master" : h.is("expert") ? "Expert" : modes[h["gameMode"]->toInt()]);
+  add("World Mode", h.is("master") ? "Master" : h.is("expert") ? "Expert" : modes[h.gameMode]);
   add("Saved Angler", h.is("savedAngler") ? on : off);
   add("Saved Mechanic", h.is("savedMechanic") ? on : off);
   add("Saved Tinkerer", h.is("savedTinkerer") ? on : off);
@@ -58,7 +60,54 @@ InfoWin::InfoWin(const World &world) {
   add("Nebula Pillar", h.is("downedNebula") ? on : off);
   add("Stardust Pillar", h.is("downedStardust") ? on : off);
   add("Moon Lord", h.is("downedMoonlord") ? on : off);
-  
+
+  addCensus(world, l10n);
+}
+
+// liquids and paint first, then every block and wall the world has, most common first
+void InfoWin::addCensus(const World &world, const L10n &l10n) {
+  const auto &bands = world.census.bands;
+  auto add = [this](std::string name, auto &&amount) {
+    CensusRow row{name, {}, 0};
+    for (int band = 0; band < Census::NumBands; band++) {
+      row.amounts[band] = amount(band);
+      row.total += row.amounts[band];
+    }
+    if (row.total > 0) {
+      census.push_back(row);
+    }
+  };
+  const char *liquids[] = {"Water", "Lava", "Honey", "Shimmer"};
+  for (int i = 0; i < 4; i++) {
+    add(liquids[i], [&](int band) {
+      return bands[band].liquids[i] / 255.0;
+    });
+  }
+  add("Painted Blocks", [&](int band) {
+    return static_cast<double>(bands[band].paintedTiles);
+  });
+  add("Painted Walls", [&](int band) {
+    return static_cast<double>(bands[band].paintedWalls);
+  });
+  size_t fixed = census.size();
+  for (size_t type = 0; type < world.info.tiles.size(); type++) {
+    std::string name(l10n.xlateItem(world.info.tiles[type].name));
+    add(name.empty() ? "Block " + std::to_string(type) : name, [&](int band) {
+      return static_cast<double>(bands[band].tiles[type]);
+    });
+  }
+  for (size_t wall = 1; wall < world.info.walls.size(); wall++) {
+    std::string name(l10n.xlateItem(world.info.walls[wall].name));
+    add(name.empty() ? "Wall " + std::to_string(wall) : name, [&](int band) {
+      return static_cast<double>(bands[band].walls[wall]);
+    });
+  }
+  std::sort(census.begin() + fixed, census.end(), [](const CensusRow &a, const CensusRow &b) {
+    if (a.total == b.total) {
+      return a.name < b.name;
+    }
+    return a.total > b.total;
+  });
 }
 
 void InfoWin::show() {
@@ -74,6 +123,35 @@ void InfoWin::show() {
     ImGui::EndTable();
   }
   ImGui::EndChild();
+
+  ImGui::SeparatorText("Census");
+  ImGui::BeginChild("##census", ImVec2(700, 250));
+  if (ImGui::BeginTable("census", Census::NumBands + 2)) {
+    ImGui::TableSetupColumn("");
+    for (int band = 0; band < Census::NumBands; band++) {
+      ImGui::TableSetupColumn(Census::bandName(band));
+    }
+    ImGui::TableSetupColumn("Total");
+    ImGui::TableHeadersRow();
+    ImGuiListClipper clipper;
+    clipper.Begin(census.size());
+    while (clipper.Step()) {
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+        const auto &row = census[i];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", row.name.c_str());
+        for (auto amount : row.amounts) {
+          ImGui::TableNextColumn();
+          ImGui::Text("%.0f", amount);
+        }
+        ImGui::TableNextColumn();
+        ImGui::Text("%.0f", row.total);
+      }
+    }
+    ImGui::EndTable();
+  }
+  ImGui::EndChild();
 }
 
 void InfoWin::add(const char *key, const char *value) {
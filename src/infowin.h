@@ -3,12 +3,16 @@
 #pragma once
 
 #include "world.h"
+#include "l10n.h"
+#include <string>
 #include <vector>
 
 class InfoWin {
   public:
-    InfoWin(const World &world);
+    InfoWin(const World &world, const L10n &l10n);
     void show();
+    // the l10n generation our census names came from
+    const int generation;
 
   private:
     void add(const char *key, const char *value);
@@ -17,4 +21,12 @@ class InfoWin {
       const char *value;
     };
     std::vector<Row> rows;
+
+    void addCensus(const World &world, const L10n &l10n);
+    struct CensusRow {
+      std::string name;
+      double amounts[Census::NumBands];
+      double total;
+    };
+    std::vector<CensusRow> census;
 };
@@ -0,0 +1,289 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "inventory.h"
+#include "worldheader.h"
+#include <SDL3/SDL_filesystem.h>
+#include <algorithm>
+#include <fstream>
+
+// bump this whenever the cache format changes
+static const uint32_t CacheVersion = 1;
+
+Inventory::Inventory(const WorldInfo &info) : info(info) {}
+
+Inventory::~Inventory() {
+  wait();
+}
+
+void Inventory::refresh(const std::vector<std::filesystem::path> &folders) {
+  if (thread) {
+    // picked up by update once the current build is done
+    queued = folders;
+    return;
+  }
+  this->folders = folders;
+  SDL_SetAtomicInt(&done, 0);
+  thread = SDL_CreateThread(buildIndex, "inventory", this);
+}
+
+void Inventory::wait() {
+  queued.reset();
+  if (thread) {
+    SDL_WaitThread(thread, nullptr);
+    thread = nullptr;
+    update();
+  }
+}
+
+void Inventory::update() {
+  if (!SDL_GetAtomicInt(&done) || !pending) {
+    return;
+  }
+  if (thread) {
+    SDL_WaitThread(thread, nullptr);
+    thread = nullptr;
+  }
+  index = std::move(pending);
+  gen++;
+  if (queued) {
+    refresh(*queued);
+    queued.reset();
+  }
+}
+
+bool Inventory::busy() const {
+  return thread != nullptr;
+}
+
+int Inventory::generation() const {
+  return gen;
+}
+
+static std::filesystem::path cacheFile() {
+  char *prefdir = SDL_GetPrefPath("seancode", "terrafirma");
+  std::filesystem::path dir = prefdir;
+  SDL_free(prefdir);
+  return dir / "inventory.cache";
+}
+
+// runs on its own thread, the current index is only read until done is set
+int Inventory::buildIndex(void *data) {
+  auto inv = static_cast<Inventory *>(data);
+  auto cache = cacheFile();
+  // the first time through, start from whatever we had last run
+  std::unique_ptr<Index> cached;
+  const Index *old = inv->index.get();
+  if (old->worlds.empty()) {
+    cached = std::make_unique<Index>();
+    if (cached->read(cache)) {
+      old = cached.get();
+    }
+  }
+  std::unordered_map<std::string, const Entry *> known;
+  for (const auto &entry : old->worlds) {
+    known[entry->path.string()] = entry.get();
+  }
+
+  auto index = std::make_unique<Index>();
+  bool changed = false;
+  for (const auto &folder : inv->folders) {
+    std::error_code ec;
+    for (const auto &file : std::filesystem::directory_iterator(folder, ec)) {
+      if (file.path().extension() != ".wld") {
+        continue;
+      }
+      auto entry = std::make_unique<Entry>();
+      entry->path = file.path();
+      entry->size = std::filesystem::file_size(entry->path, ec);
+      entry->mtime = std::filesystem::last_write_time(entry->path, ec).time_since_epoch().count();
+      if (ec) {
+        continue;
+      }
+      auto it = known.find(entry->path.string());
+      if (it != known.end() && it->second->size == entry->size && it->second->mtime == entry->mtime) {
+        *entry = *it->second;
+      } else if (inv->readWorld(*entry)) {
+        changed = true;
+      } else {
+        continue;
+      }
+      index->worlds.push_back(std::move(entry));
+    }
+  }
+  changed = changed || index->worlds.size() != old->worlds.size();
+  index->build();
+  if (changed) {
+    index->write(cache);
+  }
+  inv->pending = std::move(index);
+  SDL_SetAtomicInt(&inv->done, 1);
+  return 0;
+}
+
+bool Inventory::readWorld(Entry &entry) const {
+  WorldPreamble preamble;
+  WorldHeader header;
+  if (!header.scan(entry.path, preamble)) {
+    return false;
+  }
+  entry.title = header.title;
+  // the chest section ends where the signs begin
+  const int64_t start = preamble.sections[2];
+  const int64_t end = preamble.sections[3];
+  if (end < start) {
+    return false;
+  }
+  auto handle = std::make_shared<Handle>(entry.path.string(), end - start, start);
+  if (!handle->isOpen() || handle->length < end) {
+    return false;
+  }
+  handle->seek(start);
+  World::readChests(handle, preamble.version, info, entry.chests);
+  // a section that runs past its end is corrupt, don't index what it made up
+  if (handle->overrun) {
+    entry.chests.clear();
+    return false;
+  }
+  return true;
+}
+
+void Inventory::Index::build() {
+  items.clear();
+  for (const auto &world : worlds) {
+    for (const auto &chest : world->chests) {
+      for (const auto &item : chest.items) {
+        auto &hits = items[item.name];
+        // the same item unstacked in a chest only counts once
+        if (hits.empty() || hits.back().chest != &chest) {
+          hits.push_back({world.get(), &chest});
+        }
+      }
+    }
+  }
+}
+
+std::vector<Inventory::Result> Inventory::find(std::string_view text, const L10n &l10n) const {
+  auto lower = [](unsigned char ch) {
+    return std::tolower(ch);
+  };
+  std::string needle(text);
+  std::transform(needle.begin(), needle.end(), needle.begin(), lower);
+  std::vector<Result> results;
+  std::string name;
+  for (const auto &[key, hits] : index->items) {
+    std::string xlated(l10n.xlateItem(key));
+    name = xlated;
+    std::transform(name.begin(), name.end(), name.begin(), lower);
+    if (name.find(needle) != std::string::npos) {
+      results.push_back({std::move(xlated), hits});
+    }
+  }
+  std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+    return a.name < b.name;
+  });
+  return results;
+}
+
+bool Inventory::Index::read(const std::filesystem::path &cache) {
+  Handle handle(cache.string());
+  if (!handle.isOpen() || handle.length < 12) {
+    return false;
+  }
+  if (handle.r32() != CacheVersion) {
+    return false;
+  }
+  // read the length before tell(), the two sides of != aren't sequenced
+  uint32_t payload = handle.r32();
+  if (payload != handle.length - handle.tell()) {  // truncated
+    return false;
+  }
+  // item and prefix names are mostly repeats, so they're stored once
+  std::vector<std::string> names(handle.r32());
+  for (auto &name : names) {
+    name = handle.rs();
+  }
+  auto name = [&]() -> const std::string & {
+    uint32_t i = handle.r16();
+    static const std::string empty;
+    return i < names.size() ? names[i] : empty;
+  };
+  int numWorlds = handle.r32();
+  for (int i = 0; i < numWorlds; i++) {
+    auto entry = std::make_unique<Entry>();
+    entry->path = handle.rs();
+    entry->size = handle.r64();
+    entry->mtime = handle.r64();
+    entry->title = handle.rs();
+    entry->chests.resize(handle.r32());
+    for (auto &chest : entry->chests) {
+      chest.x = handle.r32();
+      chest.y = handle.r32();
+      chest.name = handle.rs();
+      chest.items.resize(handle.r16());
+      for (auto &item : chest.items) {
+        item.stack = handle.r16();
+        item.name = name();
+        item.prefix = name();
+      }
+    }
+    worlds.push_back(std::move(entry));
+  }
+  return true;
+}
+
+void Inventory::Index::write(const std::filesystem::path &cache) const {
+  std::unordered_map<std::string_view, uint16_t> ids;
+  std::vector<std::string_view> names;
+  auto id = [&](std::string_view name) {
+    auto [it, added] = ids.emplace(name, names.size());
+    if (added) {
+      names.push_back(name);
+    }
+    return it->second;
+  };
+  for (const auto &entry : worlds) {
+    for (const auto &chest : entry->chests) {
+      for (const auto &item : chest.items) {
+        id(item.name);
+        id(item.prefix);
+      }
+    }
+  }
+
+  Writer body;
+  body.w32(names.size());
+  for (auto name : names) {
+    body.ws(name);
+  }
+  body.w32(worlds.size());
+  for (const auto &entry : worlds) {
+    body.ws(entry->path.string());
+    body.w64(entry->size);
+    body.w64(entry->mtime);
+    body.ws(entry->title);
+    body.w32(entry->chests.size());
+    for (const auto &chest : entry->chests) {
+      body.w32(chest.x);
+      body.w32(chest.y);
+      body.ws(chest.name);
+      body.w16(chest.items.size());
+      for (const auto &item : chest.items) {
+        body.w16(item.stack);
+        body.w16(ids[item.name]);
+        body.w16(ids[item.prefix]);
+      }
+    }
+  }
+
+  Writer out;
+  out.w32(CacheVersion);
+  out.w32(body.data.length());
+  std::error_code ec;
+  std::filesystem::create_directories(cache.parent_path(), ec);
+  std::ofstream f(cache, std::ios::out | std::ios::binary);
+  if (!f.is_open()) {
+    return;
+  }
+  f.write(out.data.data(), out.data.length());
+  f.write(body.data.data(), body.data.length());
+}
@@ -0,0 +1,75 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "world.h"
+#include "l10n.h"
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The contents of every chest in every world in the world folders, so items
+ * can be found without loading a world.  Only the chest section of each
+ * world is read, and the index is cached so only worlds whose size or mtime
+ * changed get read again.
+ */
+class Inventory {
+  public:
+    struct Entry {
+      std::filesystem::path path;
+      uint64_t size = 0, mtime = 0;
+      std::string title;
+      std::vector<World::Chest> chests;
+    };
+    struct Hit {
+      const Entry *world;
+      const World::Chest *chest;
+    };
+    struct Result {
+      std::string name;  // translated
+      std::vector<Hit> hits;
+    };
+
+    explicit Inventory(const WorldInfo &info);
+    ~Inventory();
+    // rebuilds the index in the background, the old one is used until it's done
+    void refresh(const std::vector<std::filesystem::path> &folders);
+    // call every frame, adopts the new index once it's built
+    void update();
+    bool busy() const;
+    // bumped every time a new index is adopted
+    int generation() const;
+    // every item whose translated name contains text, sorted by name
+    std::vector<Result> find(std::string_view text, const L10n &l10n) const;
+
+  private:
+    struct Index {
+      bool read(const std::filesystem::path &cache);
+      void write(const std::filesystem::path &cache) const;
+      void build();
+
+      // unique_ptrs so hits stay valid as worlds are added
+      std::vector<std::unique_ptr<Entry>> worlds;
+      // internal item name to every chest it's in
+      std::unordered_map<std::string_view, std::vector<Hit>> items;
+    };
+    static int buildIndex(void *data);
+    bool readWorld(Entry &entry) const;
+    void wait();
+
+    const WorldInfo &info;
+    std::unique_ptr<Index> index = std::make_unique<Index>();
+    std::unique_ptr<Index> pending;
+    SDL_Thread *thread = nullptr;
+    SDL_AtomicInt done{};
+    std::vector<std::filesystem::path> folders;
+    std::optional<std::vector<std::filesystem::path>> queued;
+    int gen = 0;
+};
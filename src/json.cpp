@@ -21,36 +21,35 @@ enum Token {
 
 class JSONHelper {
   public:
-    JSONHelper(const std::string &data) : data(data) {
+    JSONHelper(std::string &text, std::vector<JSONData> &nodes) : data(text.data()), nodes(nodes) {
       pos = 0;
-      len = data.length();
+      len = text.length();
     }
     Token nextToken() {
       // eat leading spaces
-      while (pos < len && isspace(data.at(pos))) {
+      while (pos < len && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t')) {
         pos++;
       }
 
-      if (pos == len) {
+      if (pos >= len) {
         throw JSONParseException("Unexpected EOF", location());
       }
 
-      char c = data.at(pos++);
+      char c = data[pos++];
       if (isalpha(c)) {  // must be a keyword like null/true/false
         int start = pos - 1;
         // find end of keyword
-        while (pos < len && isalpha(data.at(pos))) {
+        while (pos < len && isalpha(data[pos])) {
           pos++;
         }
-        auto ref = data.substr(start, pos - start);
-        std::transform(ref.begin(), ref.end(), ref.begin(), [](unsigned char c){ return std::tolower(c); });
-        if (ref == "null") {
+        std::string_view ref(data + start, pos - start);
+        if (keyword(ref, "null")) {
           return TokenNULL;
         }
-        if (ref == "true") {
+        if (keyword(ref, "true")) {
           return TokenTRUE;
         }
-        if (ref == "false") {
+        if (keyword(ref, "false")) {
           return TokenFALSE;
         }
         throw JSONParseException("Unquoted string", location());
@@ -80,48 +79,51 @@ class JSONHelper {
       }
     }
 
-    std::string readString() {
-      std::string r;
-      while (pos < len && data.at(pos) != '"') {
-        if (data.at(pos) == '\\') {
+    // unescaped strings are never longer than the original, so we can
+    // unescape in place and point directly into the text.
+    std::string_view readString() {
+      int start = pos;
+      char *r = data + pos;
+      while (pos < len && data[pos] != '"') {
+        if (data[pos] == '\\') {
           pos++;
-          if (pos == len) {
-            return "";
+          if (pos >= len) {
+            throw JSONParseException("Unexpected EOF", location());
           }
-          switch (data.at(pos++)) {
+          switch (data[pos++]) {
             case '"':
-              r += '"';
+              *r++ = '"';
               break;
             case '\\':
-              r += '\\';
+              *r++ = '\\';
               break;
             case '/':
-              r += '/';
+              *r++ = '/';
               break;
             case 'b':
-              r += '\b';
+              *r++ = '\b';
               break;
             case 'f':
-              r += '\f';
+              *r++ = '\f';
               break;
             case 'n':
-              r += '\n';
+              *r++ = '\n';
               break;
             case 'r':
-              r += '\r';
+              *r++ = '\r';
               break;
             case 't':
-              r += '\t';
+              *r++ = '\t';
               break;
             case 'u':  // hex
               {
                 int num = 0;
                 for (int i = 0; i < 4; i++) {
-                  if (pos == len) {
+                  if (pos >= len) {
                     throw JSONParseException("Unexpected EOF", location());
                   }
                   num <<= 4;
-                  char c = data.at(pos++);
+                  char c = data[pos++];
                   if (c >= '0' && c <= '9') {
                     num |= c - '0';
                   } else if (c >= 'a' && c <= 'f') {
@@ -132,67 +134,80 @@ class JSONHelper {
                     throw JSONParseException("Invalid hex code", location());
                   }
                 }
-                r += num;
+                // utf-8 encode, at most 3 bytes for the 6 we just read
+                if (num < 0x80) {
+                  *r++ = num;
+                } else if (num < 0x800) {
+                  *r++ = 0xc0 | (num >> 6);
+                  *r++ = 0x80 | (num & 0x3f);
+                } else {
+                  *r++ = 0xe0 | (num >> 12);
+                  *r++ = 0x80 | ((num >> 6) & 0x3f);
+                  *r++ = 0x80 | (num & 0x3f);
+                }
               }
               break;
             default:
               throw JSONParseException("Unknown escape sequence", location());
           }
         } else {
-          r += data.at(pos++);
+          *r++ = data[pos++];
         }
       }
-      pos++;
-      return r;
+      if (pos >= len) {
+        throw JSONParseException("Unterminated string", location());
+      }
+      pos++;  // closing quote
+      return std::string_view(data + start, r - (data + start));
     }
 
     double readDouble() {
       double sign = 1.0;
-      if (data.at(pos) == '-') {
+      if (data[pos] == '-') {
         sign = -1.0;
         pos++;
-      } else if (data.at(pos) == '+') {
+      } else if (data[pos] == '+') {
         pos++;
       }
-      if (pos == len) {
+      if (pos >= len) {
         throw JSONParseException("Unxpected EOF", location());
       }
       double value = 0.0;
-      while (pos < len && isdigit(data.at(pos))) {
+      while (pos < len && isdigit(data[pos])) {
         value *= 10.0;
-        value += data.at(pos++) - '0';
+        value += data[pos++] - '0';
       }
-      if (pos == len) {
+      if (pos >= len) {
         throw JSONParseException("Unexpected EOF", location());
       }
-      if (data.at(pos) == '.') {
+      if (data[pos] == '.') {
         double pow10 = 10.0;
         pos++;
-        while (pos < len && isdigit(data.at(pos))) {
-          value += (data.at(pos++) - '0') / pow10;
+        while (pos < len && isdigit(data[pos])) {
+          value += (data[pos++] - '0') / pow10;
           pow10 *= 10.0;
         }
       }
-      if (pos == len) {
+      if (pos >= len) {
         throw JSONParseException("Unexpected EOF", location());
       }
       double scale = 1.0;
       bool frac = false;
-      if (data.at(pos) == 'e' || data.at(pos) == 'E') {
+      if (data[pos] == 'e' || data[pos] == 'E') {
         pos++;
-        if (pos == len) {
+        if (pos >= len) {
           throw JSONParseException("Unexpected EOF", location());
         }
-        if (data.at(pos) == '-') {
+        if (data[pos] == '-') {
           frac = true;
           pos++;
-        } else if (data.at(pos) == '+') {
+        } else if (data[pos] == '+') {
           pos++;
         }
         unsigned int expon = 0;
-        while (pos < len && isdigit(data.at(pos))) {
+        while (pos < len && isdigit(data[pos])) {
           expon *= 10.0;
-          expon += data.at(pos++) - '0';
+          expon += data[pos++] - '0';
         }
         if (expon > 308) {
           expon = 308;
@@ -213,13 +228,130 @@ class JSONHelper {
       return sign * (frac ? (value / scale) : (value * scale));
     }
 
+    JSONData readValue(Token type) {
+      JSONData value;
+      switch (type) {
+        case TokenNULL:
+          break;
+        case TokenTRUE:
+          value.type = JSONData::Type::Bool;
+          value.boolean = true;
+          break;
+        case TokenFALSE:
+          value.type = JSONData::Type::Bool;
+          value.boolean = false;
+          break;
+        case TokenString:
+          value.type = JSONData::Type::String;
+          value.str = readString();
+          break;
+        case TokenNumber:
+          value.type = JSONData::Type::Number;
+          value.number = readDouble();
+          break;
+        case TokenObject:
+          value = readObject();
+          break;
+        case TokenArray:
+          value = readArray();
+          break;
+        default:
+          throw JSONParseException("Expected value", location());
+      }
+      return value;
+    }
+
+    JSONData readObject() {
+      size_t base = stack.size();
+      Token type;
+
+      while ((type = nextToken()) == TokenString) {
+        auto key = readString();
+        if (key.length() == 0) {
+          throw JSONParseException("Empty key", location());
+        }
+        if (nextToken() != TokenKeySeparator) {
+          throw JSONParseException("Expected ':'", location());
+        }
+        auto value = readValue(nextToken());
+        value.name = key;
+        stack.push_back(value);
+        type = nextToken();
+        if (type == TokenObjectClose) {
+          break;
+        }
+        if (type != TokenValueSeparator) {
+          throw JSONParseException("Expected ',' or '}'", location());
+        }
+      }
+      if (type != TokenObjectClose) {
+        throw JSONParseException("Expected '}' or '\"'", location());
+      }
+
+      JSONData object;
+      object.type = JSONData::Type::Object;
+      object.first = nodes.size();
+      object.count = stack.size() - base;
+      // sorted so lookups can binary search, most objects already are
+      bool sorted = true;
+      for (size_t i = base + 1; sorted && i < stack.size(); i++) {
+        sorted = stack[i - 1].name < stack[i].name;
+      }
+      if (sorted) {
+        nodes.insert(nodes.end(), stack.begin() + base, stack.end());
+        stack.resize(base);
+        return object;
+      }
+      // the last duplicate key wins
+      order.clear();
+      for (size_t i = base; i < stack.size(); i++) {
+        order.push_back(i);
+      }
+      std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return stack[a].name < stack[b].name || (stack[a].name == stack[b].name && a < b);
+      });
+      for (size_t i = 0; i < order.size(); i++) {
+        if (i + 1 < order.size() && stack[order[i]].name == stack[order[i + 1]].name) {
+          continue;
+        }
+        nodes.push_back(stack[order[i]]);
+      }
+      object.count = nodes.size() - object.first;
+      stack.resize(base);
+      return object;
+    }
+
+    JSONData readArray() {
+      size_t base = stack.size();
+      Token type;
+
+      while ((type = nextToken()) != TokenArrayClose) {
+        stack.push_back(readValue(type));
+        type = nextToken();
+        if (type == TokenArrayClose) {
+          break;
+        }
+        if (type != TokenValueSeparator) {
+          throw JSONParseException("Expected ',' or ']'", location());
+        }
+      }
+      JSONData array;
+      array.type = JSONData::Type::Array;
+      array.first = nodes.size();
+      array.count = stack.size() - base;
+      // children move out of the stack and into the document, where they'll stay next to each other
+      nodes.insert(nodes.end(), stack.begin() + base, stack.end());
+      stack.resize(base);
+      return array;
+    }
+
     std::string location() {
       int line = 1;
       int col = 0;
-      int cpos = pos;
+      int cpos = std::min(pos, len - 1);
       bool doneCol = false;
       while (cpos >= 0) {
-        if (data.at(cpos) == '\n') {
+        if (data[cpos] == '\n') {
           doneCol = true;
           line++;
         }
@@ -230,202 +362,105 @@ class JSONHelper {
     }
 
   private:
+    static bool keyword(std::string_view ref, std::string_view word) {
+      return std::equal(ref.begin(), ref.end(), word.begin(), word.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+      });
+    }
+
+
     int pos, len;
-    std::string data;
-    std::string error;
+    char *data;
+    std::vector<JSONData> &nodes;
+    std::vector<JSONData> stack;
+    std::vector<size_t> order;
 };
 
-std::shared_ptr<JSONData> JSON::parse(const std::string &data) {
-  JSONHelper reader(data);
+std::shared_ptr<JSON> JSON::parse(std::string data) {
+  auto doc = std::make_shared<JSON>();
+  doc->text = std::move(data);
+  // our assets average a node every 10 bytes or so, this avoids most regrowth
+  doc->nodes.reserve(doc->text.size() / 16);
+  JSONHelper reader(doc->text, doc->nodes);
   auto type = reader.nextToken();
   switch (type) {
     case TokenObject:
-      return std::make_shared<JSONObject>(reader);
     case TokenArray:
-      return std::make_shared<JSONArray>(reader);
+      doc->nodes.push_back(reader.readValue(type));
+      break;
     default:
       throw JSONParseException("Object or array expected", reader.location());
   }
-  return nullptr;
-}
-
-static std::shared_ptr<JSONData> Null = std::make_shared<JSONData>();
-
-JSONData::JSONData() {}
-
-JSONData::~JSONData() {}
-
-bool JSONData::has(const std::string &) {
-  return false;
-}
-
-std::shared_ptr<JSONData> JSONData::at(const std::string &) {
-  return Null;
-}
-
-std::shared_ptr<JSONData> JSONData::at(int) {
-  return Null;
-}
-
-int JSONData::length() {
-  return 0;
-}
-
-std::string JSONData::asString() {
-  return "";
-}
-
-double JSONData::asNumber(double def) {
-  return def;
-}
-
-int16_t JSONData::asInt(int16_t def) {
-  return def;
+  // the document won't grow anymore, so indices can become pointers
+  for (auto &node : doc->nodes) {
+    if (node.type == JSONData::Type::Object || node.type == JSONData::Type::Array) {
+      node.children = doc->nodes.data() + node.first;
+    }
+  }
+  return doc;
 }
 
-bool JSONData::asBool() {
-  return false;
+const JSONData *JSON::root() const {
+  return &nodes.back();
 }
 
-JSONBool::JSONBool(bool val) : data(val) {}
+static const JSONData Null;
 
-bool JSONBool::asBool() {
-  return data;
+bool JSONData::has(std::string_view key) const {
+  return at(key) != &Null;
 }
 
-JSONString::JSONString(const std::string &val) : data(val) {}
-
-std::string JSONString::asString() {
-  return data;
+const JSONData *JSONData::at(std::string_view key) const {
+  if (type != Type::Object) {
+    return &Null;
+  }
+  auto child = std::lower_bound(begin(), end(), key, [](const JSONData &a, std::string_view key) {
+    return a.name < key;
+  });
+  if (child != end() && child->name == key) {
+    return child;
+  }
+  return &Null;
 }
 
-JSONNumber::JSONNumber(double val) : data(val) {}
-
-double JSONNumber::asNumber(double) {
-  return data;
+const JSONData *JSONData::at(int index) const {
+  if (type == Type::Array && index >= 0 && index < count) {
+    return children + index;
+  }
+  return &Null;
 }
 
-int16_t JSONNumber::asInt(int16_t) {
-  return static_cast<int16_t>(data);
+int JSONData::length() const {
+  if (type == Type::Object || type == Type::Array) {
+    return count;
+  }
+  return 0;
 }
 
-std::string JSONNumber::asString() {
-  return std::to_string(static_cast<int16_t>(data));
+std::string_view JSONData::asString() const {
+  return type == Type::String ? str : std::string_view();
 }
 
-JSONObject::JSONObject(JSONHelper &reader) {
-  Token type;
-
-  while ((type = reader.nextToken()) == TokenString) {
-    std::string key = reader.readString();
-    if (key.length() == 0) {
-      throw JSONParseException("Empty key", reader.location());
-    }
-    if (reader.nextToken() != TokenKeySeparator) {
-      throw JSONParseException("Expected ':'", reader.location());
-    }
-
-
-    std::shared_ptr<JSONData> value = Null;
-    auto token = reader.nextToken();
-
-    switch (token) {
-      case TokenNULL:
-        break;
-      case TokenTRUE:
-        value = std::make_shared<JSONBool>(true);
-        break;
-      case TokenFALSE:
-        value = std::make_shared<JSONBool>(false);
-        break;
-      case TokenString:
-        value = std::make_shared<JSONString>(reader.readString());
-        break;
-      case TokenNumber:
-        value = std::make_shared<JSONNumber>(reader.readDouble());
-        break;
-      case TokenObject:
-        value = std::make_shared<JSONObject>(reader);
-        break;
-      case TokenArray:
-        value = std::make_shared<JSONArray>(reader);
-        break;
-      default:
-        throw JSONParseException("Expected value", reader.location());
-    }
-    children[key] = value;
-    type = reader.nextToken();
-    if (type == TokenObjectClose) {
-      break;
-    }
-    if (type != TokenValueSeparator) {
-      throw JSONParseException("Expected ',' or '}'", reader.location());
-    }
-  }
-  if (type != TokenObjectClose) {
-    throw JSONParseException("Expected '}' or '\"'", reader.location());
-  }
+double JSONData::asNumber(double def) const {
+  return type == Type::Number ? number : def;
 }
 
-bool JSONObject::has(const std::string &key) {
-  return children.find(key) != children.end();
+int16_t JSONData::asInt(int16_t def) const {
+  return type == Type::Number ? static_cast<int16_t>(number) : def;
 }
 
-std::shared_ptr<JSONData> JSONObject::at(const std::string &key) {
-  if (auto child = children.find(key); child != children.end()) {
-    return child->second;
-  }
-  return Null;
+bool JSONData::asBool() const {
+  return type == Type::Bool && boolean;
 }
 
-JSONArray::JSONArray(JSONHelper &reader) {
-  Token type;
-
-  while ((type = reader.nextToken()) != TokenArrayClose) {
-    std::shared_ptr<JSONData> value = nullptr;
-    switch (type) {
-      case TokenNULL:
-        break;
-      case TokenTRUE:
-        value = std::make_shared<JSONBool>(true);
-        break;
-      case TokenFALSE:
-        value = std::make_shared<JSONBool>(false);
-        break;
-      case TokenString:
-        value = std::make_shared<JSONString>(reader.readString());
-        break;
-      case TokenNumber:
-        value = std::make_shared<JSONNumber>(reader.readDouble());
-        break;
-      case TokenObject:
-        value = std::make_shared<JSONObject>(reader);
-        break;
-      case TokenArray:
-        value = std::make_shared<JSONArray>(reader);
-        break;
-      default:
-        throw JSONParseException("Expected value", reader.location());
-    }
-
-    data.push_back(value);
-    type = reader.nextToken();
-    if (type == TokenArrayClose) {
-      break;
-    }
-    if (type != TokenValueSeparator) {
-      throw JSONParseException("Expected ',' or ']'", reader.location());
-    }
-  }
+std::string_view JSONData::key() const {
+  return name;
 }
 
-int JSONArray::length() {
-  return data.size();
+const JSONData *JSONData::begin() const {
+  return length() ? children : nullptr;
 }
 
-std::shared_ptr<JSONData> JSONArray::at(int index) {
-  if (index < data.size()) {
-    return data[index];
-  }
-  return Null;
+const JSONData *JSONData::end() const {
+  return length() ? children + count : nullptr;
 }
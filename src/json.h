@@ -3,69 +3,55 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <unordered_map>
 #include <cstdint>
 
-class JSONHelper;
-
+/*
+ * A node in a parsed JSON document.  Nodes are owned by their JSON document
+ * and are only valid as long as it is.  Missing keys and out of range
+ * indices return a null node, so lookups can be chained safely.
+ */
 class JSONData {
   public:
-    JSONData();
-    virtual ~JSONData();
-    virtual bool has(const std::string &key);
-    virtual std::shared_ptr<JSONData> at(const std::string &key);
-    virtual std::shared_ptr<JSONData> at(int index);
-    virtual int length();
-    virtual std::string asString();
-    virtual double asNumber(double def = 0.0);
-    virtual int16_t asInt(int16_t def = 0);
-    virtual bool asBool();
-};
+    enum class Type : uint8_t {
+      Null,
+      Bool,
+      Number,
+      String,
+      Object,
+      Array,
+    };
 
-class JSONBool : public JSONData {
-  public:
-    JSONBool(bool val);
-    bool asBool();
-  private:
-    bool data;
-};
+    bool has(std::string_view key) const;
+    const JSONData *at(std::string_view key) const;
+    const JSONData *at(int index) const;
+    int length() const;
+    std::string_view asString() const;
+    double asNumber(double def = 0.0) const;
+    int16_t asInt(int16_t def = 0) const;
+    bool asBool() const;
 
-class JSONString : public JSONData {
-  public:
-    JSONString(const std::string &val);
-    std::string asString();
-  private:
-    std::string data;
-};
+    // for iterating over objects
+    std::string_view key() const;
+    const JSONData *begin() const;
+    const JSONData *end() const;
 
-class JSONNumber : public JSONData {
-  public:
-    JSONNumber(double val);
-    double asNumber(double);
-    int16_t asInt(int16_t);
-    std::string asString();
   private:
-    double data;
-};
-
-class JSONObject : public JSONData {
-  public:
-    JSONObject(JSONHelper &);
-    bool has(const std::string &key);
-    std::shared_ptr<JSONData> at(const std::string &key);
-  private:
-    std::unordered_map<std::string, std::shared_ptr<JSONData>> children;
-};
+    friend class JSONHelper;
+    friend class JSON;
 
-class JSONArray : public JSONData {
-  public:
-    JSONArray(JSONHelper &);
-    std::shared_ptr<JSONData> at(int index);
-    int length();
-  private:
-    std::vector<std::shared_ptr<JSONData>> data;
+    Type type = Type::Null;
+    uint32_t count = 0;  // number of children
+    std::string_view name;  // our key, if we're in an object
+    std::string_view str;
+    union {
+      double number = 0.0;
+      bool boolean;
+      size_t first;  // index of first child while parsing
+      const JSONData *children;  // object members are sorted by key
+    };
 };
 
 class JSONParseException {
@@ -74,8 +60,17 @@ class JSONParseException {
     std::string reason;
 };
 
+/*
+ * A parsed JSON document.  Every node lives in a single array, with the
+ * children of each object or array stored next to each other. Strings point
+ * into our own copy of the text, which is unescaped in place.
+ */
 class JSON {
   public:
-    static std::shared_ptr<JSONData> parse(const std::string &data);
+    static std::shared_ptr<JSON> parse(std::string data);
+    const JSONData *root() const;
 
+  private:
+    std::string text;
+    std::vector<JSONData> nodes;
 };
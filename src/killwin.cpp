@@ -6,12 +6,12 @@
 #include <algorithm>
 
 KillWin::KillWin(const World &world, const L10n &l10n) {
-  auto list = world.header["killCount"];
-  for (int i = 0; i < list->length(); i++) {
-    if (world.info.npcsByBanner.contains(i)) {
-      std::string name = l10n.xlateNPC(world.info.npcsByBanner.at(i)->title);
+  const auto &list = world.header.killCount;
+  for (int i = 0; i < list.size(); i++) {
+    if (const auto npc = world.info.npcByBanner(i)) {
+      std::string name(l10n.xlateNPC(npc->title));
       if (!name.empty()) {
-        add(name, list->at(i)->toInt());
+        add(name, list[i]);
       }
     }
   }
@@ -27,11 +27,17 @@ void KillWin::show() {
   ImGui::SeparatorText("Kills");
   ImGui::BeginChild("##killlist", ImVec2(400, 200));
   if (ImGui::BeginTable("kills", 2)) {
-    for (const auto &row : rows) {
-      ImGui::TableNextColumn();
-      ImGui::Text("%s", row.npc.c_str());
-      ImGui::TableNextColumn();
-      ImGui::Text("%d", row.kills);
+    ImGuiListClipper clipper;
+    clipper.Begin(rows.size());
+    while (clipper.Step()) {
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+        const auto &row = rows[i];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", row.npc.c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%d", row.kills);
+      }
     }
     ImGui::EndTable();
   }
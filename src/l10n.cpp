@@ -7,9 +7,8 @@
  */
 
 #include "l10n.h"
-#include "handle.h"
 #include <SDL3/SDL.h>
-#include <regex>
+#include <fstream>
 
 enum {
   TILDE = 0,
@@ -41,7 +40,76 @@ static uint32_t fits5(uint32_t a) {
   return a > 0x7ff ? 4 : 2;
 }
 
+// bump this whenever the cache format changes
+static const uint32_t CacheVersion = 1;
+
+L10n::~L10n() {
+  wait();
+}
+
 void L10n::load(std::string exe) {
+  wait();
+  this->exe = exe;
+  language = currentLanguage;
+  SDL_SetAtomicInt(&done, 0);
+  thread = SDL_CreateThread(loadTables, "l10n", this);
+}
+
+void L10n::wait() {
+  if (thread) {
+    SDL_WaitThread(thread, nullptr);
+    thread = nullptr;
+    update();
+  }
+}
+
+void L10n::update() {
+  if (!SDL_GetAtomicInt(&done) || !pending) {
+    return;
+  }
+  if (thread) {
+    SDL_WaitThread(thread, nullptr);
+    thread = nullptr;
+  }
+  tables = std::move(pending);
+  gen++;
+}
+
+int L10n::generation() const {
+  return gen;
+}
+
+static std::filesystem::path cacheFile(const std::string &language) {
+  char *prefdir = SDL_GetPrefPath("seancode", "terrafirma");
+  std::filesystem::path dir = prefdir;
+  SDL_free(prefdir);
+  return dir / "l10n" / (language + ".cache");
+}
+
+// runs on its own thread, we only touch pending until done is set
+int L10n::loadTables(void *data) {
+  auto l10n = static_cast<L10n *>(data);
+  auto tables = std::make_unique<Tables>();
+  std::error_code ec;
+  uint64_t size = std::filesystem::file_size(l10n->exe, ec);
+  if (!ec) {
+    // the cache is only valid for the exact exe it came from
+    uint64_t mtime = std::filesystem::last_write_time(l10n->exe, ec).time_since_epoch().count();
+    auto cache = cacheFile(l10n->language);
+    if (!tables->read(cache, size, mtime)) {
+      tables = std::make_unique<Tables>();
+      tables->extract(l10n->exe, l10n->language);
+      if (!tables->languages.empty()) {
+        tables->write(cache, size, mtime);
+      }
+    }
+  }
+  l10n->pending = std::move(tables);
+  SDL_SetAtomicInt(&l10n->done, 1);
+  return 0;
+}
+
+void L10n::Tables::extract(const std::string &exe, const std::string &language) {
   Handle handle(exe);
   if (!handle.isOpen()) {
     return;
@@ -214,37 +282,106 @@ void L10n::load(std::string exe) {
     resources.push_back(std::make_shared<Resource>(name, ofs));
   }
   handle.seek(metaRVA + streams[STRINGS].offset + offset - base);
-  std::regex re("Terraria\\.Localization\\.Content\\.([^.]+)\\.([^.]+)\\.json");
+  // we're looking for Terraria.Localization.Content.<lang>.<kind>.json
+  const std::string_view prefix = "Terraria.Localization.Content.";
   for (const auto &r : resources) {
     handle.seek(metaRVA + streams[STRINGS].offset + offset - base + r->name);
     auto name = handle.rcs();
-    std::cmatch match;
-    if (std::regex_search(name.c_str(), match, re)) {
-      if (match[2] == "Items" || match[2] == "NPCs") {
-        std::string lang = match[1].str();
-        languages.insert(lang);
-        if (lang == currentLanguage) {
-          handle.seek(r->offset + resourceRVA + offset - base);
-          auto len = handle.r32();
-
-          std::string raw = handle.read(len);
-          std::regex comma(",\\s*\\}");
-          raw = std::regex_replace(raw, comma, "}");  // remove trailing commas
-          auto doc = JSON::parse(raw);
-          if (doc) {
-            if (match[2] == "Items") {
-              items.emplace(lang, doc->at("ItemName"));
-              prefixes.emplace(lang, doc->at("Prefix"));
-            } else if (match[2] == "NPCs") {
-              npcs.emplace(lang, doc->at("NPCName"));
-            }
-          }
+    std::string_view rest(name);
+    if (!rest.starts_with(prefix) || !rest.ends_with(".json")) {
+      continue;
+    }
+    rest = rest.substr(prefix.length(), rest.length() - prefix.length() - 5);
+    auto dot = rest.find('.');
+    if (dot == std::string_view::npos) {
+      continue;
+    }
+    std::string lang(rest.substr(0, dot));
+    auto kind = rest.substr(dot + 1);
+    if (kind == "Items" || kind == "NPCs") {
+      languages.insert(lang);
+      if (lang == language) {
+        handle.seek(r->offset + resourceRVA + offset - base);
+        auto len = handle.r32();
+
+        // the parser is fine with the trailing commas these have
+        auto doc = JSON::parse(handle.read(len));
+        if (kind == "Items") {
+          addTable(items, doc->root()->at("ItemName"), "{$ItemName.");
+          addTable(prefixes, doc->root()->at("Prefix"), "");
+        } else {
+          addTable(npcs, doc->root()->at("NPCName"), "{$NPCName.");
         }
       }
     }
   }
 }
 
+bool L10n::Tables::read(const std::filesystem::path &cache, uint64_t size, uint64_t mtime) {
+  Handle handle(cache.string());
+  if (!handle.isOpen() || handle.length < 24) {
+    return false;
+  }
+  if (handle.r32() != CacheVersion || handle.r64() != size || handle.r64() != mtime) {
+    return false;
+  }
+  // read the length before tell(), the two sides of != aren't sequenced
+  uint32_t payload = handle.r32();
+  if (payload != handle.length - handle.tell()) {  // truncated
+    return false;
+  }
+  int numLanguages = handle.r32();
+  for (int i = 0; i < numLanguages; i++) {
+    languages.insert(handle.rs());
+  }
+  readTable(handle, items);
+  readTable(handle, prefixes);
+  readTable(handle, npcs);
+  return true;
+}
+
+void L10n::Tables::write(const std::filesystem::path &cache, uint64_t size, uint64_t mtime) const {
+  Writer body;
+  body.w32(languages.size());
+  for (const auto &lang : languages) {
+    body.ws(lang);
+  }
+  writeTable(body, items);
+  writeTable(body, prefixes);
+  writeTable(body, npcs);
+
+  Writer out;
+  out.w32(CacheVersion);
+  out.w64(size);
+  out.w64(mtime);
+  out.w32(body.data.length());
+  std::error_code ec;
+  std::filesystem::create_directories(cache.parent_path(), ec);
+  std::ofstream f(cache, std::ios::out | std::ios::binary);
+  if (!f.is_open()) {
+    return;
+  }
+  f.write(out.data.data(), out.data.length());
+  f.write(body.data.data(), body.data.length());
+}
+
+void L10n::Tables::readTable(Handle &handle, Table &table) {
+  int num = handle.r32();
+  table.reserve(num);
+  for (int i = 0; i < num; i++) {
+    const auto &key = intern(handle.rs());
+    table.emplace(key, &intern(handle.rs()));
+  }
+}
+
+void L10n::Tables::writeTable(Writer &out, const Table &table) const {
+  out.w32(table.size());
+  for (const auto &[key, value] : table) {
+    out.ws(key);
+    out.ws(*value);
+  }
+}
+
 void L10n::setLanguage(std::string lang) {
   currentLanguage = lang;
 }
@@ -255,45 +392,77 @@ std::string L10n::selectedLanguage() const {
 
 std::vector<std::string> L10n::getLanguages() const {
   std::vector<std::string> v;
-  v.assign(languages.begin(), languages.end());
+  v.assign(tables->languages.begin(), tables->languages.end());
   return v;
 }
 
-std::string L10n::xlateItem(const std::string &key) const {
-  auto json = items.find(currentLanguage);
-  if (json == items.end()) {
-    return key;
+// replaces references like {$ItemName.Foo} with the translation of Foo
+static std::string expand(const JSONData *json, std::string_view str, std::string_view tag, int depth) {
+  std::string r;
+  size_t pos = 0;
+  while (!tag.empty()) {
+    auto start = str.find(tag, pos);
+    if (start == std::string_view::npos) {
+      break;
+    }
+    auto end = str.find('}', start);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    r += str.substr(pos, start - pos);
+    auto ref = str.substr(start + tag.length(), end - start - tag.length());
+    auto sub = json->at(ref)->asString();
+    if (sub.empty()) {
+      r += ref;
+    } else if (depth < 8) {  // don't loop forever on a circular reference
+      r += expand(json, sub, tag, depth + 1);
+    } else {
+      r += sub;
+    }
+    pos = end + 1;
   }
-  auto str = json->second->at(key)->asString();
-  std::regex re("\\{\\$ItemName\\.(.+?)\\}");
-  std::cmatch match;
-  if (std::regex_search(str.c_str(), match, re)) {
-    str = std::regex_replace(str, re, xlateItem(match[1]));
+  r += str.substr(pos);
+  return r;
+}
+
+void L10n::Tables::addTable(Table &table, const JSONData *json, std::string_view tag) {
+  table.reserve(table.size() + json->length());
+  for (const auto &entry : *json) {
+    const auto &key = intern(std::string(entry.key()));
+    if (!table.contains(key)) {
+      table.emplace(key, &intern(expand(json, entry.asString(), tag, 0)));
+    }
   }
-  if (str.length() == 0) {
+}
+
+// identical strings are only stored once, and never move
+const std::string &L10n::Tables::intern(std::string s) {
+  return *strings.insert(std::move(s)).first;
+}
+
+std::string_view L10n::xlateItem(std::string_view key) const {
+  if (tables->items.empty()) {
     return key;
   }
-  return str;
+  auto str = tables->items.find(key);
+  if (str == tables->items.end() || str->second->empty()) {
+    return key;
+  }
+  return *str->second;
 }
 
-std::string L10n::xlatePrefix(const std::string &key) const {
-  auto json = prefixes.find(currentLanguage);
-  if (json == prefixes.end()) {
+std::string_view L10n::xlatePrefix(std::string_view key) const {
+  if (tables->prefixes.empty()) {
     return key;
   }
-  return json->second->at(key)->asString();
+  auto str = tables->prefixes.find(key);
+  return str == tables->prefixes.end() ? std::string_view() : *str->second;
 }
 
-std::string L10n::xlateNPC(const std::string &key) const {
-  auto json = npcs.find(currentLanguage);
-  if (json == npcs.end()) {
+std::string_view L10n::xlateNPC(std::string_view key) const {
+  if (tables->npcs.empty()) {
     return key;
   }
-  auto str = json->second->at(key)->asString();
-  std::regex re("\\{\\$NPCName\\.(.+?)\\}");
-  std::cmatch match;
-  if (std::regex_search(str.c_str(), match, re)) {
-    str = std::regex_replace(str, re, xlateNPC(match[1]));
-  }
-  return str;
+  auto str = tables->npcs.find(key);
+  return str == tables->npcs.end() ? std::string_view() : *str->second;
 }
@@ -8,23 +8,62 @@ It parses the language files from terraria.exe to translate item names
 */
 
 #include "json.h"
+#include "handle.h"
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+#include <filesystem>
 #include <string>
+#include <string_view>
 #include <set>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 class L10n {
   public:
+    ~L10n();
+    // loads in the background, untranslated keys are returned until it's done
     void load(std::string exe);
-    std::string xlateItem(const std::string &key) const;
-    std::string xlatePrefix(const std::string &key) const;
-    std::string xlateNPC(const std::string &key) const;
+    // call every frame, adopts the new translations once they're loaded
+    void update();
+    // bumped every time new translations are adopted
+    int generation() const;
+    // views stay valid until the next update(), misses give back the key,
+    // so copy anything that has to outlive either
+    std::string_view xlateItem(std::string_view key) const;
+    std::string_view xlatePrefix(std::string_view key) const;
+    std::string_view xlateNPC(std::string_view key) const;
     std::vector<std::string> getLanguages() const;
     void setLanguage(std::string lang);
     std::string selectedLanguage() const;
 
   private:
-    std::unordered_map<std::string, std::shared_ptr<JSONData>> items;
-    std::unordered_map<std::string, std::shared_ptr<JSONData>> prefixes;
-    std::unordered_map<std::string, std::shared_ptr<JSONData>> npcs;
-    std::set<std::string> languages;
+    // translations for a single language, with all references resolved
+    using Table = std::unordered_map<std::string_view, const std::string *>;
+    struct Tables {
+      void extract(const std::string &exe, const std::string &language);
+      bool read(const std::filesystem::path &cache, uint64_t size, uint64_t mtime);
+      void write(const std::filesystem::path &cache, uint64_t size, uint64_t mtime) const;
+      void addTable(Table &table, const JSONData *json, std::string_view tag);
+      void readTable(Handle &handle, Table &table);
+      void writeTable(Writer &out, const Table &table) const;
+      const std::string &intern(std::string s);
+
+      std::set<std::string> languages;
+      std::unordered_set<std::string> strings;
+      Table items;
+      Table prefixes;
+      Table npcs;
+    };
+    static int loadTables(void *data);
+    void wait();
+
+    std::unique_ptr<Tables> tables = std::make_unique<Tables>();
+    std::unique_ptr<Tables> pending;
+    SDL_Thread *thread = nullptr;
+    SDL_AtomicInt done{};
+    std::string exe;
+    std::string language;
     std::string currentLanguage = "en-US";
+    int gen = 0;
 };
@@ -0,0 +1,221 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "lighting.h"
+#include "pool.h"
+#include "world.h"
+#include <algorithm>
+
+// how much light survives passing through a tile, out of 256
+static const uint8_t AirDecay = 233;
+static const uint8_t WaterDecay = 225;
+static const uint8_t HoneyDecay = 192;
+static const uint8_t SolidDecay = 143;
+
+void Lighting::reset(int width, int height) {
+  this->width = width;
+  this->height = height;
+  rgba.assign(static_cast<size_t>(width) * height * 4, 0);
+  const int size = 1 << ChunkShift;
+  chunksWide = (width + size - 1) >> ChunkShift;
+  chunksHigh = (height + size - 1) >> ChunkShift;
+  lit.assign(chunksWide * chunksHigh, false);
+  generation++;
+}
+
+Lighting::Region Lighting::update(const World &world, Pool &pool, int x0, int y0, int x1, int y1) {
+  Region region;
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, width);
+  y1 = std::min(y1, height);
+  if (x1 <= x0 || y1 <= y0) {
+    return region;
+  }
+  // only relight the chunks that need it
+  int cx0 = chunksWide, cy0 = chunksHigh, cx1 = -1, cy1 = -1;
+  for (int cy = y0 >> ChunkShift; cy <= (y1 - 1) >> ChunkShift; cy++) {
+    for (int cx = x0 >> ChunkShift; cx <= (x1 - 1) >> ChunkShift; cx++) {
+      if (!lit[cy * chunksWide + cx]) {
+        cx0 = std::min(cx0, cx);
+        cy0 = std::min(cy0, cy);
+        cx1 = std::max(cx1, cx);
+        cy1 = std::max(cy1, cy);
+      }
+    }
+  }
+  if (cx1 < 0) {
+    return region;
+  }
+  for (int cy = cy0; cy <= cy1; cy++) {
+    for (int cx = cx0; cx <= cx1; cx++) {
+      lit[cy * chunksWide + cx] = true;
+    }
+  }
+  region.x0 = cx0 << ChunkShift;
+  region.y0 = cy0 << ChunkShift;
+  region.x1 = std::min((cx1 + 1) << ChunkShift, width);
+  region.y1 = std::min((cy1 + 1) << ChunkShift, height);
+
+  // light from just outside the region still reaches into it
+  Grid grid;
+  grid.x0 = std::max(region.x0 - Margin, 0);
+  grid.y0 = std::max(region.y0 - Margin, 0);
+  grid.w = std::min(region.x1 + Margin, width) - grid.x0;
+  grid.h = std::min(region.y1 + Margin, height) - grid.y0;
+
+  seed(world, grid, pool);
+  spread(grid, pool);
+
+  int rows = region.y1 - region.y0;
+  int jobs = pool.size();
+  for (int job = 0; job < jobs; job++) {
+    pool.add([&, job]() {
+      int start = region.y0 + rows * job / jobs;
+      int end = region.y0 + rows * (job + 1) / jobs;
+      for (int y = start; y < end; y++) {
+        size_t src = static_cast<size_t>(y - grid.y0) * grid.w + (region.x0 - grid.x0);
+        size_t offset = static_cast<size_t>(y) * width + region.x0;
+        uint8_t *dest = rgba.data() + offset * 4;
+        for (int x = region.x0; x < region.x1; x++, src++, offset++) {
+          // illuminant coating is always fully lit
+          if (world.tiles[offset].Is() & IsGlowing) {
+            *dest++ = 0xff;
+            *dest++ = 0xff;
+            *dest++ = 0xff;
+          } else {
+            *dest++ = grid.r[src];
+            *dest++ = grid.g[src];
+            *dest++ = grid.b[src];
+          }
+          *dest++ = 0xff;
+        }
+      }
+    });
+  }
+  pool.wait();
+  return region;
+}
+
+static uint8_t channel(double light) {
+  return static_cast<uint8_t>(std::clamp(light, 0.0, 1.0) * 255);
+}
+
+void Lighting::seed(const World &world, Grid &grid, Pool &pool) {
+  size_t len = static_cast<size_t>(grid.w) * grid.h;
+  grid.r.resize(len);
+  grid.g.resize(len);
+  grid.b.resize(len);
+  grid.decay.resize(len);
+  int jobs = pool.size();
+  for (int job = 0; job < jobs; job++) {
+    pool.add([&, job]() {
+      int start = grid.h * job / jobs;
+      int end = grid.h * (job + 1) / jobs;
+      for (int gy = start; gy < end; gy++) {
+        int y = grid.y0 + gy;
+        // the sun only reaches down to the surface
+        bool sky = y < world.header.groundLevel;
+        const Tile *tile = world.tiles + static_cast<size_t>(y) * world.tilesWide + grid.x0;
+        size_t i = static_cast<size_t>(gy) * grid.w;
+        for (int gx = 0; gx < grid.w; gx++, tile++, i++) {
+          uint8_t r = 0, g = 0, b = 0;
+          bool solid = false;
+          if (tile->active()) {
+            auto info = world.info[*tile];
+            solid = info->solid && !tile->inactive() && !(tile->Is() & IsClear);
+            r = channel(info->lightR);
+            g = channel(info->lightG);
+            b = channel(info->lightB);
+          }
+          uint8_t decay = solid ? SolidDecay : AirDecay;
+          if (!solid && tile->liquid > 0) {
+            if (tile->shimmer()) {
+              r = std::max<uint8_t>(r, 128);
+              g = std::max<uint8_t>(g, 77);
+              b = std::max<uint8_t>(b, 178);
+              decay = WaterDecay;
+            } else if (tile->honey()) {
+              decay = HoneyDecay;
+            } else if (tile->lava()) {
+              r = std::max<uint8_t>(r, 140);
+              g = std::max<uint8_t>(g, 84);
+              b = std::max<uint8_t>(b, 28);
+              decay = WaterDecay;
+            } else {
+              decay = WaterDecay;
+            }
+          }
+          if (sky && !solid && tile->wall == 0) {
+            r = g = b = 0xff;
+          }
+          grid.r[i] = r;
+          grid.g[i] = g;
+          grid.b[i] = b;
+          grid.decay[i] = decay;
+        }
+      }
+    });
+  }
+  pool.wait();
+}
+
+// each tile keeps the brighter of its own light and what its neighbor passes on
+static inline uint8_t pass(uint8_t light, uint8_t neighbor, uint8_t decay) {
+  return std::max<uint16_t>(light, (neighbor * decay) >> 8);
+}
+
+void Lighting::spread(Grid &grid, Pool &pool) {
+  const int w = grid.w;
+  const int h = grid.h;
+  uint8_t *planes[] = {grid.r.data(), grid.g.data(), grid.b.data()};
+  const uint8_t *decay = grid.decay.data();
+  int jobs = pool.size() * 4;
+  for (int round = 0; round < 2; round++) {
+    // rows depend on the tile before, so each one is swept on its own
+    for (int job = 0; job < jobs; job++) {
+      pool.add([&, job]() {
+        int start = static_cast<int64_t>(h) * job / jobs;
+        int end = static_cast<int64_t>(h) * (job + 1) / jobs;
+        for (auto plane : planes) {
+          for (int y = start; y < end; y++) {
+            uint8_t *row = plane + static_cast<size_t>(y) * w;
+            const uint8_t *d = decay + static_cast<size_t>(y) * w;
+            for (int x = 1; x < w; x++) {
+              row[x] = pass(row[x], row[x - 1], d[x]);
+            }
+            for (int x = w - 2; x >= 0; x--) {
+              row[x] = pass(row[x], row[x + 1], d[x]);
+            }
+          }
+        }
+      });
+    }
+    pool.wait();
+    // columns are swept a whole row segment at a time, which vectorizes
+    for (int job = 0; job < jobs; job++) {
+      pool.add([&, job]() {
+        int start = static_cast<int64_t>(w) * job / jobs;
+        int end = static_cast<int64_t>(w) * (job + 1) / jobs;
+        for (auto plane : planes) {
+          for (int y = 1; y < h; y++) {
+            uint8_t *row = plane + static_cast<size_t>(y) * w;
+            const uint8_t *prev = row - w;
+            const uint8_t *d = decay + static_cast<size_t>(y) * w;
+            for (int x = start; x < end; x++) {
+              row[x] = pass(row[x], prev[x], d[x]);
+            }
+          }
+          for (int y = h - 2; y >= 0; y--) {
+            uint8_t *row = plane + static_cast<size_t>(y) * w;
+            const uint8_t *next = row + w;
+            const uint8_t *d = decay + static_cast<size_t>(y) * w;
+            for (int x = start; x < end; x++) {
+              row[x] = pass(row[x], next[x], d[x]);
+            }
+          }
+        }
+      });
+    }
+    pool.wait();
+  }
+}
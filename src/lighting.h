@@ -0,0 +1,53 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class World;
+class Pool;
+
+/*
+ * Terraria style lighting.  Every tile starts with the light it gives off,
+ * then that light is swept along rows and down columns, losing some of it
+ * with every tile it passes through.  Two rounds of sweeps lets it bend
+ * around corners the way it does in game.
+ *
+ * Nothing is lit until it's asked for, a chunk at a time, so only the parts
+ * of the world that are actually looked at ever get lit.
+ */
+class Lighting {
+  public:
+    struct Region {
+      int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+      bool empty() const { return x1 <= x0 || y1 <= y0; }
+    };
+    // forgets everything, call when a new world is loaded
+    void reset(int width, int height);
+    // lights whatever hasn't been lit yet in [x0, x1) x [y0, y1), returns
+    // the tiles whose light changed
+    Region update(const World &world, Pool &pool, int x0, int y0, int x1, int y1);
+
+    // light reaching every tile, rgba in the same layout as World::colors
+    std::vector<uint8_t> rgba;
+    int width = 0, height = 0;
+    // bumped by every reset
+    int generation = 0;
+
+  private:
+    // light and how much of it survives each tile, for a region plus a margin
+    struct Grid {
+      int x0, y0, w, h;
+      std::vector<uint8_t> r, g, b, decay;
+    };
+    static void seed(const World &world, Grid &grid, Pool &pool);
+    static void spread(Grid &grid, Pool &pool);
+
+    static const int ChunkShift = 7;
+    // the brightest light fades out before it gets this far
+    static const int Margin = 64;
+
+    std::vector<bool> lit;  // per chunk
+    int chunksWide = 0, chunksHigh = 0;
+};
@@ -15,6 +15,8 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/matrix.hpp>
+#include <algorithm>
+#include <charconv>
 
 const float MaxZoom = 2.2f;
 const float MinZoom = 0.01f;
@@ -26,11 +28,21 @@ const float TileLayer = 2.f;
 const float ItemLayer = 3.f;
 const float NPCLayer = 3.5f;
 const float LiquidLayer = 4.f;
+const float LightLayer = 4.5f;  // wires and houses stay lit
 const float WireLayer = 5.f;
 const float HouseLayer = 6.f;
 
 Map::Map(World &world) : world(world) {}
 
+Map::~Map() {
+  SDL_SetAtomicInt(&cancelMerge, 1);
+  merging.clear();
+  merging.wait();
+  if (mergedMutex != nullptr) {
+    SDL_DestroyMutex(mergedMutex);
+  }
+}
+
 std::string Map::init(SDL_GPUDevice *gpu) {
   return renderer.init(gpu);
 }
@@ -70,21 +82,94 @@ glm::ivec2 Map::mouseToTile(float x, float y) {
   return glm::ivec2(tileX, tileY);
 }
 
-std::string Map::getStatus(const L10n &l10n, float x, float y) {
+// the inverse of mouseToTile, for drawing over the map
+glm::vec2 Map::tileToScreen(float x, float y) {
+  auto pt = project() * glm::vec4(x * 16, y * 16, 0, 1.0);
+  return glm::vec2((pt.x + 1.f) * (winWidth / 2.f), (1.f - pt.y) * (winHeight / 2.f));
+}
+
+void Map::translateNames(const L10n &l10n) {
+  namesGeneration = l10n.generation();
+  const auto &info = world.info;
+  tileNames.clear();
+  for (const auto &tile : info.tiles) {
+    tileNames.emplace_back(l10n.xlateItem(tile.name));
+  }
+  for (const auto &variant : info.variants) {
+    tileNames.emplace_back(l10n.xlateItem(variant.name));
+  }
+  wallNames.clear();
+  for (const auto &wall : info.walls) {
+    wallNames.emplace_back(l10n.xlateItem(wall.name));
+  }
+}
+
+// appends an int without going through a temporary string
+static void appendInt(std::string &s, int value) {
+  char buf[12];
+  auto end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+  s.append(buf, end);
+}
+
+void Map::getStatus(std::string &status, const L10n &l10n, float x, float y) {
+  status.clear();
   if (!world.loaded) {
-    return "";
+    return;
+  }
+  if (namesGeneration != l10n.generation() || tileNames.empty()) {
+    translateNames(l10n);
   }
   auto pos = mouseToTile(x, y);
   const auto &tile = world.tiles[pos.y * world.tilesWide + pos.x];
-  std::string r = std::to_string(pos.x) + "," + std::to_string(pos.y);
+  appendInt(status, pos.x);
+  status += ',';
+  appendInt(status, pos.y);
   if (tile.active()) {
-    auto info = world.info[tile];
-    r += " : " + l10n.xlateItem(info->name);
-  } else if (tile.wall > 0) {
-    auto info = world.info.walls[tile.wall];
-    r += " : " + l10n.xlateItem(info->name);
+    // tileNames is in the same order as the ids, unknown types have no name
+    auto id = world.info.id(world.info[tile]);
+    status += " : ";
+    if (id < tileNames.size()) {
+      status += tileNames[id];
+    }
+  } else if (tile.wall > 0 && tile.wall < wallNames.size()) {
+    status += " : ";
+    status += wallNames[tile.wall];
   }
-  return r;
+  world.objects.at(pos.x, pos.y, [&](const ObjectIndex::Object &obj) {
+    switch (obj.kind) {
+      case ObjectIndex::Kind::Chest:
+        if (!world.chests[obj.index].name.empty()) {
+          status += " : ";
+          status += world.chests[obj.index].name;
+        }
+        break;
+      case ObjectIndex::Kind::NPC:
+        {
+          const auto &npc = world.npcs[obj.index];
+          status += " : ";
+          if (npc.name.empty()) {
+            status += l10n.xlateNPC(npc.title);
+          } else {
+            status += npc.name;
+          }
+        }
+        break;
+      case ObjectIndex::Kind::ItemFrame:
+        if (world.itemFrames[obj.index].stack > 0) {
+          status += " : ";
+          status += l10n.xlateItem(world.info.item(world.itemFrames[obj.index].itemid));
+        }
+        break;
+      case ObjectIndex::Kind::WeaponRack:
+        if (world.weaponRacks[obj.index].item > 0) {
+          status += " : ";
+          status += l10n.xlateItem(world.info.item(world.weaponRacks[obj.index].item));
+        }
+        break;
+      default:
+        break;
+    }
+  });
 }
 
 void Map::drag(float dx, float dy) {
@@ -102,11 +187,11 @@ void Map::scale(float amt) {
 }
 
 void Map::jumpToSpawn() {
-  jumpToLocation(world.header["spawnX"]->toDouble(), world.header["spawnY"]->toDouble());
+  jumpToLocation(world.header.spawnX, world.header.spawnY);
 }
 
 void Map::jumpToDungeon() {
-  jumpToLocation(world.header["dungeonX"]->toDouble(), world.header["dungeonY"]->toDouble());
+  jumpToLocation(world.header.dungeonX, world.header.dungeonY);
 }
 
 void Map::jumpToLocation(float x, float y) {
@@ -121,7 +206,9 @@ void Map::npcMenu(const L10n &l10n) {
     if (npc.name.empty()) {
       name += l10n.xlateNPC(npc.title);
     } else {
-      name += npc.name + " the " + l10n.xlateNPC(npc.title);
+      name += npc.name;
+      name += " the ";
+      name += l10n.xlateNPC(npc.title);
     }
     if (npc.homeless) {
       name += "'s Location";
@@ -152,6 +239,11 @@ void Map::showHouses(bool houses) {
   dirty = true;
 }
 
+void Map::showLighting(bool lighting) {
+  this->lighting = lighting;
+  dirty = true;
+}
+
 bool Map::loaded() {
   return world.loaded;
 }
@@ -164,6 +256,15 @@ void Map::copy(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   if (!world.loaded) {
     return;
   }
+  if (mergedMutex != nullptr) {
+    std::vector<std::vector<HiliteInstance>> bands;
+    SDL_LockMutex(mergedMutex);
+    bands.swap(mergedBands);
+    SDL_UnlockMutex(mergedMutex);
+    for (const auto &rects : bands) {
+      renderer.addHilites(copy, rects);
+    }
+  }
   if (!dirty) {
     return;
   }
@@ -183,7 +284,9 @@ void Map::copy(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   } else {
     drawFlat(gpu, copy);
   }
-  drawHilited(gpu, copy);
+  if (lighting) {
+    drawLight(gpu, copy);
+  }
   renderer.copy(copy);
 }
 
@@ -621,7 +724,9 @@ void Map::drawWalls(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
     int offset = y * stride + startX;
     for (int x = startX; x < endX; x++, offset++) {
       const auto &tile = world.tiles[offset];
-      if (tile.wall > 0) {
+      auto occlusion = world.occlusion[offset];
+      // nothing of this wall would show through the tiles in front of it
+      if (tile.wall > 0 && !(occlusion & Covered)) {
         if (tile.wallu < 0) {
           UVRules::mapWall(world, x, y);
         }
@@ -634,28 +739,32 @@ void Map::drawWalls(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
         }
 
         renderer.addTile(copy, Textures::Wall | tile.wall, x * 16 - 8, y * 16 - 8, WallLayer, 32, 32, tile.wallu, tile.wallv, paint, false);
-        int blend = world.info.walls[tile.wall]->blend;
+        // outlines stay inside the tile, so its block hides them
+        if (occlusion & Opaque) {
+          continue;
+        }
+        int blend = world.info.wall(tile.wall)->blend;
         if (x > 0) {
           int wall = world.tiles[offset - 1].wall;
-          if (wall > 0 && world.info.walls[wall]->blend != blend) {
+          if (wall > 0 && world.info.wall(wall)->blend != blend) {
             renderer.addTile(copy, Textures::Outline, x * 16, y * 16, OutlineLayer, 2, 16, 0, 0, 0, false);
           }
         }
         if (x < world.tilesWide - 2) {
           int wall = world.tiles[offset + 1].wall;
-          if (wall > 0 && world.info.walls[wall]->blend != blend) {
+          if (wall > 0 && world.info.wall(wall)->blend != blend) {
             renderer.addTile(copy, Textures::Outline, x * 16 + 14, y * 16, OutlineLayer, 2, 16, 14, 0, 0, false);
           }
         }
         if (y > 0) {
           int wall = world.tiles[offset - stride].wall;
-          if (wall > 0 && world.info.walls[wall]->blend != blend) {
+          if (wall > 0 && world.info.wall(wall)->blend != blend) {
             renderer.addTile(copy, Textures::Outline, x * 16, y * 16, OutlineLayer, 16, 2, 0, 0, 0, false);
           }
         }
         if (y < world.tilesHigh - 2) {
           int wall = world.tiles[offset + stride].wall;
-          if (wall > 0 && world.info.walls[wall]->blend != blend) {
+          if (wall > 0 && world.info.wall(wall)->blend != blend) {
             renderer.addTile(copy, Textures::Outline, x * 16, y * 16 + 14, OutlineLayer, 16, 2, 0, 14, 0, false);
           }
         }
@@ -677,21 +786,20 @@ static int backStyles[] = {
 };
 
 void Map::drawBackground(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
-  int groundLevel = world.header["groundLevel"]->toInt();
-  int rockLevel = world.header["rockLevel"]->toInt();
-  int hellLevel = ((world.tilesHigh - 330) - groundLevel) / 6;
-  hellLevel = hellLevel * 6 + groundLevel - 5;
+  int groundLevel = static_cast<int>(world.header.groundLevel);
+  int rockLevel = static_cast<int>(world.header.rockLevel);
+  int hellLevel = world.header.hellLevel();
   int hellBottom = ((world.tilesHigh - 200) - hellLevel) / 6;
   hellBottom = hellBottom * 6 + hellLevel - 5;
 
-  int hellStyle = world.header["hellBackStyle"]->toInt();
+  int hellStyle = world.header.hellBackStyle;
 
   renderer.addHBG(copy, Textures::Background | 0, 0, 0, world.tilesWide, groundLevel);
 
   int lastX = 0;
   for (int i = 0; i <= 3; i++) {
-    int style = world.header["caveBackStyle"]->at(i)->toInt() * 7;
-    int nextX = i == 3 ? world.tilesWide : world.header["caveBackX"]->at(i)->toInt();
+    int style = world.header.caveBackStyle[i] * 7;
+    int nextX = i == 3 ? world.tilesWide : world.header.caveBackX[i];
     renderer.addBG(copy, Textures::Background | backStyles[style], lastX, groundLevel - 1, nextX - lastX, 1);
     renderer.addBG(copy, Textures::Background | backStyles[style + 1], lastX, groundLevel, nextX - lastX, rockLevel - groundLevel);
     renderer.addBG(copy, Textures::Background | backStyles[style + 2], lastX, rockLevel, nextX - lastX, 1);
@@ -704,140 +812,59 @@ void Map::drawBackground(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   renderer.addHBG(copy, Textures::Underworld | 4, 0, hellBottom, world.tilesWide, world.tilesHigh - hellBottom);
 }
 
+// texture variant and opacity of water, lava, honey and shimmer
+static const int liquidVariants[4] = {0, 1, 11, 14};
+static const double liquidAlphas[4] = {0.5, 0.9, 0.85, 0.85};
+
+// where the liquid behind an edge tile goes, by edge mask and side level
+static const struct LiquidEdges {
+  struct Shape {
+    uint8_t xpad, ypad, w, h;
+  };
+  Shape shapes[32][16];
+  LiquidEdges() {
+    for (int mask = 0; mask < 32; mask++) {
+      for (int level = 0; level < 16; level++) {
+        Shape shape = {0, 0, 16, 16};
+        if (mask == 2) {
+          shape.h = 4;
+        } else if (mask == 0x12) {
+          shape.h = 12;
+        } else if ((mask & 0xf) == 1) {
+          shape.h = 4;
+          shape.ypad = 12;
+        } else if (!(mask & 2)) {
+          shape.h = 16 - level;
+          shape.ypad = level;
+          if ((mask & 0x1c) == 8) {
+            shape.w = 4;
+          }
+          if ((mask & 0x1c) == 4) {
+            shape.w = 4;
+            shape.xpad = 12;
+          }
+        }
+        shapes[mask][level] = shape;
+      }
+    }
+  }
+} liquidEdges;
+
 void Map::drawLiquids(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   int stride = world.tilesWide;
   for (int y = startY; y < endY; y++) {
     int offset = y * stride + startX;
     for (int x = startX; x < endX; x++, offset++) {
-      const auto &tile = world.tiles[offset];
-      const auto &info = world.info[tile];
-      // draw liquid behind edge tiles
-      if (tile.active() && info->solid && !tile.inactive() && x > 0 && y > 0 && x < world.tilesWide - 1 && y < world.tilesHigh - 1) {
-        const auto &right = world.tiles[offset + 1];
-        const auto &left = world.tiles[offset - 1];
-        const auto &up = world.tiles[offset - stride];
-        const auto &down = world.tiles[offset + stride];
-        uint8_t sideLevel = 0;
-        int v = 4;
-        int waterw = 16;
-        int waterh = 16;
-        int xpad = 0, ypad = 0;
-        int mask = 0;
-        double alpha = 0.5;
-        int variant = 0;
-
-        if (left.liquid > 0 && tile.slope != 1 && tile.slope != 3) {
-          sideLevel = left.liquid;
-          mask |= 8;
-          if (left.shimmer()) {
-            variant = 14;
-            alpha = 0.85;
-          } else if (left.honey()) {
-            variant = 11;
-            alpha = 0.85;
-          } else if (left.lava()) {
-            variant = 1;
-            alpha = 0.9;
-          }
-        }
-        if (right.liquid > 0 && tile.slope != 2 && tile.slope != 4) {
-          if (sideLevel < right.liquid) {
-            sideLevel = right.liquid;
-          }
-          mask |= 4;
-          if (right.shimmer()) {
-            variant = 14;
-            alpha = 0.85;
-          } else if (right.honey()) {
-            variant = 11;
-            alpha = 0.85;
-          } else if (right.lava()) {
-            variant = 1;
-            alpha = 0.9;
-          }
-        }
-        if (up.liquid > 0 && tile.slope != 3 && tile.slope != 4) {
-          mask |= 2;
-          if (up.shimmer()) {
-            variant = 14;
-            alpha = 0.85;
-          } else if (up.honey()) {
-            variant = 11;
-            alpha = 0.85;
-          } else if (up.lava()) {
-            variant = 1;
-            alpha = 0.9;
-          }
-        } else if (!up.active() || !world.info[up.type]->solid || tile.slope == 3 || tile.slope == 4) {
-          v = 0;  // water has a ripple
-        }
-        if (down.liquid > 0 && tile.slope != 1 && tile.slope != 2) {
-          if (down.liquid > 240) {
-            mask |= 1;
-          }
-          if (down.shimmer()) {
-            variant = 14;
-            alpha = 0.85;
-          } else if (down.honey()) {
-            variant = 11;
-            alpha = 0.85;
-          } else if (down.lava()) {
-            variant = 1;
-            alpha = 0.9;
-          }
-        }
-        if (mask) {
-          if ((mask & 0xc) && (mask & 1)) {  // down + any side is the same as both sides
-            mask |= 0xc;
-          }
-          if (tile.half() || tile.slope) {
-            mask |= 0x10;
-          }
-
-          sideLevel = (255 - sideLevel) / 16;
-          if (mask == 2) {
-            waterh = 4;
-          } else if (mask == 0x12) {
-            waterh = 12;
-          } else if ((mask & 0xf) == 1) {
-            waterh = 4;
-            ypad = 12;
-          } else if (!(mask & 2)) {
-            waterh = 16 - sideLevel;
-            ypad = sideLevel;
-            if ((mask & 0x1c) == 8) {
-              waterw = 4;
-            }
-            if ((mask & 0x1c) == 4) {
-              waterw = 4;
-              xpad = 12;
-            }
-          }
-
-          renderer.addLiquid(copy, Textures::LiquidEdge | variant, x * 16 + xpad, y * 16 + ypad, LiquidEdgeLayer, waterw, waterh, v, alpha);
-        }
-      }
-      if (tile.liquid > 0 && (!tile.active() || !info->solid)) {
-        int waterLevel = (255 - tile.liquid) / 16.0;
-        int variant = 0;
-        double alpha = 0.5;
-        if (tile.shimmer()) {
-          variant = 14;
-          alpha = 0.85;
-        } else if (tile.honey()) {
-          variant = 11;
-          alpha = 0.85;
-        } else if (tile.lava()) {
-          variant = 1;
-          alpha = 0.9;
-        }
-        int v = 0;
-        // ripple?
-        const auto &up = world.tiles[offset - stride];
-        if (up.liquid > 32 || (up.active() && world.info[up.type]->solid)) {
-          v = 4;
-        }
-        renderer.addLiquid(copy, Textures::Liquid | variant, x * 16, y * 16 + waterLevel, LiquidLayer, 16, 16 - waterLevel, v, alpha);
+      auto cell = world.liquidCells[offset];
+      int variant = liquidVariants[cell.kind];
+      double alpha = liquidAlphas[cell.kind];
+      int v = cell.calm ? 4 : 0;  // otherwise it has a ripple
+      if (cell.body) {
+        renderer.addLiquid(copy, Textures::Liquid | variant, x * 16, y * 16 + cell.shape, LiquidLayer, 16, 16 - cell.shape, v, alpha);
+      } else if (cell.shape) {
+        // liquid behind edge tiles
+        const auto &shape = liquidEdges.shapes[cell.shape][cell.level];
+        renderer.addLiquid(copy, Textures::LiquidEdge | variant, x * 16 + shape.xpad, y * 16 + shape.ypad, LiquidEdgeLayer, shape.w, shape.h, v, alpha);
       }
     }
   }
@@ -861,21 +888,18 @@ void Map::drawWires(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
       }
       int wires = tile.Is() & (IsRedWire | IsBlueWire | IsGreenWire | IsYellowWire);
       if (wires) {
+        int masks = world.wireMasks[offset];
         if (wires & IsRedWire) {
-          int mask = wireMask(x, y, IsRedWire);
-          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, mask * 18, voffset, 0, false);
+          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, (masks & 0xf) * 18, voffset, 0, false);
         }
         if (wires & IsBlueWire) {
-          int mask = wireMask(x, y, IsBlueWire);
-          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, mask * 18, 18 + voffset, 0, false);
+          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, ((masks >> 4) & 0xf) * 18, 18 + voffset, 0, false);
         }
         if (wires & IsGreenWire) {
-          int mask = wireMask(x, y, IsGreenWire);
-          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, mask * 18, 36 + voffset, 0, false);
+          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, ((masks >> 8) & 0xf) * 18, 36 + voffset, 0, false);
         }
         if (wires & IsYellowWire) {
-          int mask = wireMask(x, y, IsYellowWire);
-          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, mask * 18, 54 + voffset, 0, false);
+          renderer.addTile(copy, Textures::Wires, x * 16, y * 16, WireLayer, 16, 16, (masks >> 12) * 18, 54 + voffset, 0, false);
         }
       }
     }
@@ -884,12 +908,16 @@ void Map::drawWires(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
 
 void Map::drawNPCs(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   int stride = world.tilesWide;
-  for (const auto &npc : world.npcs) {
-    if (npc.sprite != 0 && (npc.x + 32) / 16 >= startX && npc.x / 16 < endX && (npc.y + 56) / 16 >= startY && npc.y / 16 < endY) {
-      int offset = static_cast<int>(npc.y / 16) * stride + static_cast<int>(npc.x / 16);
-      int ht = 56;
-      renderer.addTile(copy, Textures::NPC | npc.sprite, npc.x, npc.y - 14, NPCLayer, 0, ht, 0, 0, 0, false);
+  world.objects.in(startX, startY, endX, endY, [&](const ObjectIndex::Object &obj) {
+    if (obj.kind != ObjectIndex::Kind::NPC) {
+      return;
     }
+    const auto &npc = world.npcs[obj.index];
+    if (npc.sprite != 0) {
+      renderer.addTile(copy, Textures::NPC | npc.sprite, npc.x, npc.y - 14, NPCLayer, 0, 56, 0, 0, 0, false);
+    }
+  });
+  for (const auto &npc : world.npcs) {
     if (houses && npc.head != 0 && !npc.homeless) {
       int hx = npc.homeX;
       int hy = npc.homeY - 1;
@@ -914,34 +942,20 @@ void Map::drawNPCs(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   }
 }
 
-int Map::wireMask(int x, int y, uint16_t color) {
-  int mask = 0;
-  int offset = x + y * world.tilesWide;
-  if (y > 0 && (world.tiles[offset - world.tilesWide].Is() & color)) {
-    mask |= 1;
-  }
-  if (x < world.tilesWide && (world.tiles[offset + 1].Is() & color)) {
-    mask |= 2;
+void Map::drawLight(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
+  if (lightGeneration != world.light.generation) {
+    renderer.resetLight();
+    lightGeneration = world.light.generation;
   }
-  if (y < world.tilesHigh - 1 && (world.tiles[offset + world.tilesWide].Is() & color)) {
-    mask |= 4;
-  }
-  if (x > 0 && (world.tiles[offset - 1].Is() & color)) {
-    mask |= 8;
-  }
-  return mask;
+  auto lit = world.light.update(world, world.pool, startX, startY, endX, endY);
+  renderer.updateLight(copy, world.light.rgba.data(), world.tilesWide, world.tilesHigh, lit.x0, lit.y0, lit.x1, lit.y1);
+  renderer.addLight(startX, startY, endX, endY, LightLayer);
 }
 
 void Map::drawFlat(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
   renderer.addFlat(copy, world.colors, startX, startY, endX, endY, world.tilesWide, world.tilesHigh);
 }
 
-void Map::drawHilited(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy) {
-  for (const auto &h : hilited) {
-    renderer.addHilite(copy, h.x, h.y, hiliteSize.x, hiliteSize.y);
-  }
-}
-
 glm::mat4 Map::project() {
   float w = static_cast<float>(winWidth) / zoom;
   float h = static_cast<float>(winHeight) / zoom;
@@ -996,7 +1010,7 @@ int Map::getTreeVariant(int offset) {
     case TileCorruptJungle:
       return 1;
     case TileJungleGrass:
-      return offset <= world.header["groundLevel"]->toInt() * world.tilesWide ? 2 : 6;
+      return offset <= static_cast<int>(world.header.groundLevel) * world.tilesWide ? 2 : 6;
     case TileMushroomGrass:
       return 7;
     case TileHallowGrass:
@@ -1020,7 +1034,7 @@ int Map::getFoliage(int x, int y, int *variant, int *texw, int *texh) {
       switch (world.tiles[offset].type) {
         case TileGrass:
         case TileMowed:
-          return world.header.treeStyle(x);
+          return world.header.treeStyleAt(x);
         case TileCorruptGrass:
         case TileCorruptJungle:  
           return 1;
@@ -1032,18 +1046,18 @@ int Map::getFoliage(int x, int y, int *variant, int *texw, int *texh) {
         case TileJungleGrass:
           *texw = 114;
           *texh = 96;
-          if (offset >= world.header["groundLevel"]->toInt() * world.tilesWide) {
+          if (offset >= static_cast<int>(world.header.groundLevel) * world.tilesWide) {
             *texw = 116;
             return 13;
           }
-          if (world.header["treeTops"]->at(5)->toInt() == 1) {
+          if (world.header.treeTop(5) == 1) {
             *texw = 116;
             return 11;
           }
           return 2;
         case TileSnow:
           {
-            int alt = world.header["treeTops"]->at(6)->toInt();
+            int alt = world.header.treeTop(6);
             if (alt == 0) {
               if (x % 10 == 0) {
                 return 18;
@@ -1062,7 +1076,7 @@ int Map::getFoliage(int x, int y, int *variant, int *texw, int *texh) {
         case TileHallowGrass:
         case TileHallowMowed:
           *texh = 140;
-          switch (world.header["treeTops"]->at(7)->toInt()) {
+          switch (world.header.treeTop(7)) {
             case 2:
             case 3:
               (*variant) += (x % 6) * 3;
@@ -1081,39 +1095,142 @@ int Map::getFoliage(int x, int y, int *variant, int *texw, int *texh) {
   return 0;
 }
 
-bool Map::doneSearching() {
-  return hiliteSize.x != -1;
-}
-
 void Map::stopHilite() {
+  // any bands still merging are for the old selection
+  SDL_SetAtomicInt(&cancelMerge, 1);
+  merging.clear();
+  merging.wait();
+  SDL_SetAtomicInt(&cancelMerge, 0);
+  if (mergedMutex != nullptr) {
+    SDL_LockMutex(mergedMutex);
+    mergedBands.clear();
+    SDL_UnlockMutex(mergedMutex);
+  }
   renderer.hiliteBlock(false);
-  hilited.clear();
+  renderer.resetHilites(0);
+  hilited = {};
+  hiliteBlock = nullptr;
+  hiliteTiles.clear();
+  hiliteTilesCount = 0;
   dirty = true;
 }
 
-bool Map::hilite(std::shared_ptr<TileInfo> hilite, SDL_Mutex *mutex) {
+void Map::hilite(const TileInfo *hilite) {
+  stopHilite();
+  hilited = world.blocks.find(hilite);
+  hiliteBlock = hilite;
+  startHilite();
+}
+
+void Map::hilite(std::vector<TileIndex::Span> tiles) {
+  stopHilite();
+  hiliteTiles = std::move(tiles);
+  hilited = hiliteTiles;
+  hiliteTilesCount = 0;
+  for (const auto &span : hiliteTiles) {
+    hiliteTilesCount += span.len;
+  }
+  startHilite();
+}
+
+void Map::startHilite() {
+  if (mergedMutex == nullptr) {
+    mergedMutex = SDL_CreateMutex();
+  }
   renderer.hiliteBlock(true);
-  int offset = 0;
-  int count = 0;
-  SDL_LockMutex(mutex);
-  hiliteSize.x = -1;
-  SDL_UnlockMutex(mutex);
-  for (int y = 0; y < world.tilesHigh; y++) {
-    for (int x = 0; x < world.tilesWide; x++, offset++) {
-      const auto &tile = world.tiles[offset];
-      if (tile.active()) {
-        if (world.info[tile] == hilite && count < 1000) {
-          SDL_LockMutex(mutex);
-          hilited.push_back(glm::vec2(x * 16, y * 16));
-          SDL_UnlockMutex(mutex);
-          count++;
-        }
-      }
+  nextHilite = 0;
+  nearHiliteBuilt = false;
+  // merging only ever makes fewer rectangles than there are spans
+  renderer.resetHilites(hilited.size());
+  // more bands than threads, so a dense band doesn't hold up the rest
+  int bands = std::max(16, merging.size() * 4);
+  size_t first = 0;
+  for (int band = 1; band <= bands; band++) {
+    int endX = static_cast<int64_t>(world.tilesWide) * band / bands;
+    size_t last = std::lower_bound(hilited.begin() + first, hilited.end(), endX, [](const TileIndex::Span &s, int x) {
+      return s.x < x;
+    }) - hilited.begin();
+    if (last > first) {
+      merging.add([this, first, last]() {
+        mergeHilites(first, last);
+      });
     }
+    first = last;
   }
-  SDL_LockMutex(mutex);
-  hiliteSize = glm::vec2(hilite->width - 2, hilite->height - 2);
   dirty = true;
-  SDL_UnlockMutex(mutex);
-  return count < 1000;
+}
+
+// columns with identical runs next to each other become a single rectangle
+void Map::mergeHilites(size_t first, size_t last) {
+  struct Rect {
+    int x, y, w, h;
+  };
+  std::vector<HiliteInstance> rects;
+  auto emit = [&rects](const Rect &r) {
+    rects.emplace_back(glm::vec2(r.x * 16, r.y * 16), glm::vec2(r.w * 16, r.h * 16));
+  };
+  // rectangles that reach the previous column, sorted by y
+  std::vector<Rect> open, next;
+  size_t i = first;
+  while (i < last) {
+    if (SDL_GetAtomicInt(&cancelMerge)) {
+      return;
+    }
+    int x = hilited[i].x;
+    bool adjacent = !open.empty() && open[0].x + open[0].w == x;
+    size_t o = 0;
+    for (; i < last && hilited[i].x == x; i++) {
+      const auto &span = hilited[i];
+      while (adjacent && o < open.size() && open[o].y < span.y) {
+        emit(open[o++]);
+      }
+      if (adjacent && o < open.size() && open[o].y == span.y && open[o].h == span.len) {
+        auto r = open[o++];
+        r.w++;
+        next.push_back(r);
+      } else {
+        next.push_back({x, span.y, 1, span.len});
+      }
+    }
+    for (; o < open.size(); o++) {
+      emit(open[o]);
+    }
+    open.swap(next);
+    next.clear();
+  }
+  for (const auto &r : open) {
+    emit(r);
+  }
+  SDL_LockMutex(mergedMutex);
+  mergedBands.push_back(std::move(rects));
+  SDL_UnlockMutex(mergedMutex);
+}
+
+uint64_t Map::hiliteCount() {
+  return hiliteBlock ? world.blocks.count(hiliteBlock) : hiliteTilesCount;
+}
+
+void Map::jumpToHilite() {
+  if (hilited.empty()) {
+    return;
+  }
+  if (nextHilite >= hilited.size()) {
+    nextHilite = 0;
+  }
+  const auto &span = hilited[nextHilite++];
+  jumpToLocation(span.x, span.y + span.len / 2.0f);
+}
+
+void Map::jumpToNearestHilite(int x, int y) {
+  if (hilited.empty()) {
+    return;
+  }
+  if (!nearHiliteBuilt) {
+    nearHilite.build(hilited, world.tilesWide, world.tilesHigh);
+    nearHiliteBuilt = true;
+  }
+  const auto hits = nearHilite.nearest(x, y, 1);
+  if (!hits.empty()) {
+    jumpToLocation(hits[0].x, hits[0].y);
+  }
 }
@@ -2,17 +2,22 @@
 #pragma once
 
 #include "SDL3/SDL_mutex.h"
+#include <SDL3/SDL_atomic.h>
 #include "l10n.h"
 #include "world.h"
 #include "renderer.h"
+#include "pool.h"
+#include "nearindex.h"
 
 #include <filesystem>
+#include <span>
 #include <glm/vec2.hpp>
 #include <SDL3/SDL_gpu.h>
 
 class Map {
   public:
     Map(World &world);
+    ~Map();
     std::string init(SDL_GPUDevice *gpu);
     bool setTextures(const std::filesystem::path &path);
     void setSize(int w, int h);
@@ -22,7 +27,8 @@ class Map {
     std::string progress();
     void copy(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
     void render(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *renderPass);
-    std::string getStatus(const L10n &l10n, float x, float y);
+    // describes what's under the mouse, reusing status's storage
+    void getStatus(std::string &status, const L10n &l10n, float x, float y);
     void drag(float dx, float dy);
     void scale(float amt);
     void jumpToLocation(float x, float y);
@@ -32,10 +38,19 @@ class Map {
     void showTextures(bool textures);
     void showWires(bool wires);
     void showHouses(bool houses);
-    bool hilite(std::shared_ptr<TileInfo> hilite, SDL_Mutex *mutex);
+    void showLighting(bool lighting);
+    void hilite(const TileInfo *hilite);
+    // highlights any set of tiles, such as a circuit
+    void hilite(std::vector<TileIndex::Span> tiles);
     void stopHilite();
-    bool doneSearching();
+    // number of highlighted tiles
+    uint64_t hiliteCount();
+    // cycles through the highlighted blocks
+    void jumpToHilite();
+    // jumps to the highlighted block closest to a tile
+    void jumpToNearestHilite(int x, int y);
     glm::ivec2 mouseToTile(float x, float y);
+    glm::vec2 tileToScreen(float x, float y);
 
   private:
     void drawTiles(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
@@ -45,12 +60,14 @@ class Map {
     void drawWires(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
     void drawNPCs(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
     void drawFlat(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
-    void drawHilited(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
+    void drawLight(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy);
+    void startHilite();
+    void mergeHilites(size_t first, size_t last);
+    void translateNames(const L10n &l10n);
     int getFoliage(int x, int y, int *variant, int *texw, int *texh);
     int getTreeVariant(int offset);
     int getPalmVariant(int offset);
     int findBranchStyle(int x, int y);
-    int wireMask(int x, int y, uint16_t color);
     void calcBounds();
     glm::mat4 project();
 
@@ -61,9 +78,27 @@ class Map {
     float centerX, centerY, zoom = 1.0;
     int startX = 0, startY = 0, endX = 0, endY = 0;
     bool dirty = true;
-    std::vector<glm::vec2> hilited;
-    glm::vec2 hiliteSize;
+    std::span<const TileIndex::Span> hilited;
+    const TileInfo *hiliteBlock = nullptr;
+    std::vector<TileIndex::Span> hiliteTiles;  // when it isn't a block
+    uint64_t hiliteTilesCount = 0;
+    size_t nextHilite = 0;
+    NearIndex nearHilite;  // built the first time it's needed
+    bool nearHiliteBuilt = false;
+    // highlights are merged into rectangles a band of columns at a time,
+    // each band is uploaded as soon as it's done
+    std::vector<std::vector<HiliteInstance>> mergedBands;
+    SDL_Mutex *mergedMutex = nullptr;
+    SDL_AtomicInt cancelMerge{};
+    Pool merging;
+    // translated names of every tile, variant and wall, the status line is
+    // rebuilt on every mouse move so it shouldn't have to look them up
+    std::vector<std::string> tileNames;
+    std::vector<std::string> wallNames;
+    int namesGeneration = -1;
     bool textures;
     bool wires;
     bool houses;
+    bool lighting = false;
+    int lightGeneration = 0;  // of the light map the renderer has
 };
@@ -0,0 +1,154 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "nearindex.h"
+#include <algorithm>
+#include <queue>
+
+void NearIndex::build(std::span<const TileIndex::Span> spans, int tilesWide, int tilesHigh) {
+  const int size = 1 << CellShift;
+  cellsWide = (tilesWide + size - 1) >> CellShift;
+  cellsHigh = (tilesHigh + size - 1) >> CellShift;
+  starts.assign(cellsWide * cellsHigh + 1, 0);
+  // count, then place, so each cell's runs end up next to each other
+  auto split = [size](const TileIndex::Span &span, auto &&fn) {
+    int y = span.y, end = span.y + span.len;
+    while (y < end) {
+      int next = std::min(end, (y / size + 1) * size);
+      fn(TileIndex::Span{span.x, static_cast<uint16_t>(y), static_cast<uint16_t>(next - y)});
+      y = next;
+    }
+  };
+  auto cell = [this](const TileIndex::Span &s) {
+    return (s.y >> CellShift) * cellsWide + (s.x >> CellShift);
+  };
+  for (const auto &span : spans) {
+    split(span, [&](const TileIndex::Span &s) {
+      starts[cell(s) + 1]++;
+    });
+  }
+  for (size_t i = 1; i < starts.size(); i++) {
+    starts[i] += starts[i - 1];
+  }
+  runs.resize(starts.back());
+  std::vector<uint32_t> fill(starts.begin(), starts.end() - 1);
+  for (const auto &span : spans) {
+    split(span, [&](const TileIndex::Span &s) {
+      runs[fill[cell(s)]++] = s;
+    });
+  }
+}
+
+bool NearIndex::empty() const {
+  return runs.empty();
+}
+
+NearIndex::Hit NearIndex::closest(const TileIndex::Span &span, int x, int y) {
+  int ty = std::clamp(y, static_cast<int>(span.y), span.y + span.len - 1);
+  int64_t dx = span.x - x, dy = ty - y;
+  return {span.x, ty, dx * dx + dy * dy};
+}
+
+template <class Fn>
+void NearIndex::visit(int cx, int cy, Fn &&fn) const {
+  if (cx < 0 || cy < 0 || cx >= cellsWide || cy >= cellsHigh) {
+    return;
+  }
+  int c = cy * cellsWide + cx;
+  for (uint32_t i = starts[c]; i < starts[c + 1]; i++) {
+    fn(runs[i]);
+  }
+}
+
+std::vector<NearIndex::Hit> NearIndex::nearest(int x, int y, int k) const {
+  std::vector<Hit> hits;
+  if (k <= 0 || runs.empty()) {
+    return hits;
+  }
+  // the worst of the best k is on top
+  auto farther = [](const Hit &a, const Hit &b) {
+    return a.dist2 < b.dist2;
+  };
+  std::priority_queue<Hit, std::vector<Hit>, decltype(farther)> best(farther);
+  // the ring bound below only holds for points inside the grid
+  const int size = 1 << CellShift;
+  x = std::clamp(x, 0, cellsWide * size - 1);
+  y = std::clamp(y, 0, cellsHigh * size - 1);
+  auto consider = [&](const TileIndex::Span &span) {
+    // every tile of a run is a separate hit, but only the closest few matter
+    int ty = std::clamp(y, static_cast<int>(span.y), span.y + span.len - 1);
+    for (int up = ty; up >= span.y && up > ty - k; up--) {
+      Hit h = closest({span.x, static_cast<uint16_t>(up), 1}, x, y);
+      if (best.size() < k) {
+        best.push(h);
+      } else if (h.dist2 < best.top().dist2) {
+        best.pop();
+        best.push(h);
+      } else {
+        break;
+      }
+    }
+    for (int down = ty + 1; down < span.y + span.len && down <= ty + k; down++) {
+      Hit h = closest({span.x, static_cast<uint16_t>(down), 1}, x, y);
+      if (best.size() < k) {
+        best.push(h);
+      } else if (h.dist2 < best.top().dist2) {
+        best.pop();
+        best.push(h);
+      } else {
+        break;
+      }
+    }
+  };
+  int cx = x >> CellShift;
+  int cy = y >> CellShift;
+  int maxRing = std::max(cellsWide, cellsHigh);
+  for (int ring = 0; ring <= maxRing; ring++) {
+    if (ring == 0) {
+      visit(cx, cy, consider);
+    } else {
+      for (int i = -ring; i <= ring; i++) {
+        visit(cx + i, cy - ring, consider);
+        visit(cx + i, cy + ring, consider);
+      }
+      for (int i = -ring + 1; i < ring; i++) {
+        visit(cx - ring, cy + i, consider);
+        visit(cx + ring, cy + i, consider);
+      }
+    }
+    // anything in the next ring is at least this far away
+    int64_t reach = static_cast<int64_t>(ring) * size;
+    if (best.size() == k && best.top().dist2 <= reach * reach) {
+      break;
+    }
+  }
+  while (!best.empty()) {
+    hits.push_back(best.top());
+    best.pop();
+  }
+  std::reverse(hits.begin(), hits.end());
+  return hits;
+}
+
+std::vector<NearIndex::Hit> NearIndex::within(int x, int y, int radius) const {
+  std::vector<Hit> hits;
+  if (radius < 0 || runs.empty()) {
+    return hits;
+  }
+  int64_t r2 = static_cast<int64_t>(radius) * radius;
+  for (int cy = (y - radius) >> CellShift; cy <= (y + radius) >> CellShift; cy++) {
+    for (int cx = (x - radius) >> CellShift; cx <= (x + radius) >> CellShift; cx++) {
+      visit(cx, cy, [&](const TileIndex::Span &span) {
+        for (int ty = span.y; ty < span.y + span.len; ty++) {
+          Hit h = closest({span.x, static_cast<uint16_t>(ty), 1}, x, y);
+          if (h.dist2 <= r2) {
+            hits.push_back(h);
+          }
+        }
+      });
+    }
+  }
+  std::sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+    return a.dist2 < b.dist2;
+  });
+  return hits;
+}
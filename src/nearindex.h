@@ -0,0 +1,39 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "tileindex.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ * Finds the occurrences of a block closest to a point.  The block's runs
+ * are bucketed into a grid of 64x64 tile cells, and searches work outward
+ * a ring of cells at a time, stopping once no farther cell could hold
+ * anything closer.
+ */
+class NearIndex {
+  public:
+    struct Hit {
+      int x, y;
+      int64_t dist2;  // squared distance in tiles
+    };
+    void build(std::span<const TileIndex::Span> spans, int tilesWide, int tilesHigh);
+    bool empty() const;
+    // the k closest tiles, closest first
+    std::vector<Hit> nearest(int x, int y, int k) const;
+    // every tile within radius, closest first
+    std::vector<Hit> within(int x, int y, int radius) const;
+
+  private:
+    static const int CellShift = 6;
+    template <class Fn> void visit(int cx, int cy, Fn &&fn) const;
+    static Hit closest(const TileIndex::Span &span, int x, int y);
+
+    int cellsWide = 0, cellsHigh = 0;
+    // runs split at cell boundaries and grouped by cell, cell i has
+    // runs[starts[i]] through runs[starts[i + 1]]
+    std::vector<uint32_t> starts;
+    std::vector<TileIndex::Span> runs;
+};
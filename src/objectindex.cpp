@@ -0,0 +1,44 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "objectindex.h"
+#include <algorithm>
+
+// std::clamp and std::max bind it by reference, so it needs a definition
+const int ObjectIndex::MaxSize;
+
+void ObjectIndex::clear() {
+  objects.clear();
+  starts.clear();
+  cellsWide = cellsHigh = 0;
+}
+
+void ObjectIndex::add(Kind kind, uint32_t index, int x, int y, int w, int h) {
+  objects.push_back({
+    kind, index,
+    static_cast<int16_t>(x), static_cast<int16_t>(y),
+    static_cast<uint8_t>(std::clamp(w, 1, MaxSize)), static_cast<uint8_t>(std::clamp(h, 1, MaxSize)),
+  });
+}
+
+void ObjectIndex::finish(int tilesWide, int tilesHigh) {
+  const int size = 1 << CellShift;
+  cellsWide = (tilesWide + size - 1) >> CellShift;
+  cellsHigh = (tilesHigh + size - 1) >> CellShift;
+  // anything outside the world can never be found
+  std::erase_if(objects, [&](const Object &o) {
+    return o.x < 0 || o.y < 0 || o.x >= tilesWide || o.y >= tilesHigh;
+  });
+  auto cell = [this](const Object &o) {
+    return (o.y >> CellShift) * cellsWide + (o.x >> CellShift);
+  };
+  std::stable_sort(objects.begin(), objects.end(), [&](const Object &a, const Object &b) {
+    return cell(a) < cell(b);
+  });
+  starts.assign(cellsWide * cellsHigh + 1, 0);
+  for (const auto &o : objects) {
+    starts[cell(o) + 1]++;
+  }
+  for (size_t i = 1; i < starts.size(); i++) {
+    starts[i] += starts[i - 1];
+  }
+}
@@ -0,0 +1,59 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Everything in the world that has a position, bucketed by the 32x32 tile
+ * cell its top left corner is in.  Objects are small, so a lookup only has
+ * to check the cells it touches plus a border the size of the largest one.
+ */
+class ObjectIndex {
+  public:
+    enum class Kind : uint8_t {
+      Chest, Sign, NPC, ItemFrame, WeaponRack, HatRack, Doll,
+    };
+    struct Object {
+      Kind kind;
+      uint32_t index;  // into the world's list of that kind
+      int16_t x, y;  // in tiles
+      uint8_t w, h;
+    };
+    void clear();
+    void add(Kind kind, uint32_t index, int x, int y, int w, int h);
+    // call once everything has been added
+    void finish(int tilesWide, int tilesHigh);
+    // every object covering a tile
+    template <class Fn> void at(int x, int y, Fn &&fn) const {
+      in(x, y, x + 1, y + 1, fn);
+    }
+    // every object overlapping tiles [x0, x1) x [y0, y1)
+    template <class Fn> void in(int x0, int y0, int x1, int y1, Fn &&fn) const {
+      int cx0 = std::max(0, (x0 - MaxSize) >> CellShift);
+      int cy0 = std::max(0, (y0 - MaxSize) >> CellShift);
+      int cx1 = std::min(cellsWide - 1, (x1 - 1) >> CellShift);
+      int cy1 = std::min(cellsHigh - 1, (y1 - 1) >> CellShift);
+      for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+          int c = cy * cellsWide + cx;
+          for (uint32_t i = starts[c]; i < starts[c + 1]; i++) {
+            const auto &o = objects[i];
+            if (o.x < x1 && o.x + o.w > x0 && o.y < y1 && o.y + o.h > y0) {
+              fn(o);
+            }
+          }
+        }
+      }
+    }
+
+  private:
+    static const int CellShift = 5;
+    static const int MaxSize = 4;
+
+    int cellsWide = 0, cellsHigh = 0;
+    std::vector<Object> objects;  // sorted by cell once finished
+    std::vector<uint32_t> starts;  // cell i has objects[starts[i]] through objects[starts[i + 1]]
+};
@@ -0,0 +1,196 @@
+/** @copyright 2025 Sean Kasun */
+
+// Packs the json asset tables into a single binary file, so the game
+// doesn't have to parse json every time it starts up.
+// It also turns header.json into a typed struct and its decoder.
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include "json.h"
+#include "handle.h"
+#include "worldinfo.h"
+
+struct Field {
+  std::string name, member;
+  std::string type;  // c++ type of a single element
+  std::string read;  // handle method that reads a single element
+  int size;  // fewest bytes a single element takes in the file
+  int num;
+  std::string relnum;
+  int minVersion, maxVersion;
+};
+
+static Field parseField(const JSONData *data) {
+  Field f;
+  f.name = data->at("name")->asString();
+  for (auto ch : f.name) {
+    if (isalnum(ch) || ch == '_') {
+      f.member += ch;
+    }
+  }
+  f.name = f.member;
+  std::string t(data->at("type")->asString());
+  if (t.empty() || t == "b") {
+    f.type = "bool";
+    f.read = "r8";
+    f.size = 1;
+  } else if (t == "s") {
+    f.type = "std::string";
+    f.read = "rs";
+    f.size = 1;
+  } else if (t == "u8") {
+    f.type = "uint8_t";
+    f.read = "r8";
+    f.size = 1;
+  } else if (t == "i16") {
+    f.type = "int16_t";
+    f.read = "r16";
+    f.size = 2;
+  } else if (t == "i32") {
+    f.type = "int32_t";
+    f.read = "r32";
+    f.size = 4;
+  } else if (t == "i64") {
+    f.type = "int64_t";
+    f.read = "r64";
+    f.size = 8;
+  } else if (t == "f32") {
+    f.type = "float";
+    f.read = "rf";
+    f.size = 4;
+  } else if (t == "f64") {
+    f.type = "double";
+    f.read = "rd";
+    f.size = 8;
+  } else {
+    throw JSONParseException("Invalid header type: " + t + " on " + f.name, "");
+  }
+  f.num = data->at("num")->asInt();
+  f.relnum = data->at("relnum")->asString();
+  f.minVersion = data->at("min")->asInt();
+  f.maxVersion = data->at("max")->asInt();
+  return f;
+}
+
+static std::string memberType(const Field &f) {
+  if (!f.relnum.empty()) {
+    return "std::vector<" + f.type + ">";
+  }
+  if (f.num) {
+    return "std::array<" + f.type + ", " + std::to_string(f.num) + ">";
+  }
+  return f.type;
+}
+
+static std::string readValue(const Field &f) {
+  std::string r = "handle." + f.read + "()";
+  if (f.type == "bool" || f.type == "std::string" || f.type == "float" || f.type == "double") {
+    return r;
+  }
+  return "static_cast<" + f.type + ">(" + r + ")";
+}
+
+static bool writeFields(const std::vector<Field> &fields, const std::string &cppName, const std::string &hName) {
+  FILE *h = fopen(hName.c_str(), "wb");
+  if (!h) {
+    fprintf(stderr, "Failed to create %s\n", hName.c_str());
+    return false;
+  }
+  fprintf(h, "#pragma once\n// generated from header.json by pack, do not edit\n");
+  fprintf(h, "#include \"handle.h\"\n#include <array>\n#include <cstdint>\n#include <string>\n#include <string_view>\n#include <vector>\n\n");
+  fprintf(h, "class HeaderFields {\n  public:\n");
+  for (const auto &f : fields) {
+    fprintf(h, "    %s %s{};\n", memberType(f).c_str(), f.member.c_str());
+  }
+  fprintf(h, "\n    void decode(Handle &handle, int version);\n\n");
+  fprintf(h, "    template <class Fn>\n    void visit(Fn &&fn) const {\n");
+  for (const auto &f : fields) {
+    fprintf(h, "      fn(std::string_view(\"%s\"), %s);\n", f.name.c_str(), f.member.c_str());
+  }
+  fprintf(h, "    }\n};\n");
+  fclose(h);
+
+  FILE *cpp = fopen(cppName.c_str(), "wb");
+  if (!cpp) {
+    fprintf(stderr, "Failed to create %s\n", cppName.c_str());
+    return false;
+  }
+  auto include = std::filesystem::path(hName).filename().string();
+  fprintf(cpp, "// generated from header.json by pack, do not edit\n#include \"%s\"\n#include <algorithm>\n\n", include.c_str());
+  fprintf(cpp, "void HeaderFields::decode(Handle &handle, int version) {\n  *this = HeaderFields();\n");
+  for (const auto &f : fields) {
+    std::string indent = "  ";
+    if (f.minVersion || f.maxVersion) {
+      fprintf(cpp, "  if (version >= %d", f.minVersion);
+      if (f.maxVersion) {
+        fprintf(cpp, " && version <= %d", f.maxVersion);
+      }
+      fprintf(cpp, ") {\n");
+      indent = "    ";
+    }
+    if (!f.relnum.empty()) {
+      // counts come straight from the file, never trust more than it could hold
+      fprintf(cpp, "%s%s.resize(std::clamp<int64_t>(%s, 0, handle.remaining() / %d));\n",
+          indent.c_str(), f.member.c_str(), f.relnum.c_str(), f.size);
+    }
+    if (!f.relnum.empty() || f.num) {
+      fprintf(cpp, "%sfor (auto &v : %s) {\n", indent.c_str(), f.member.c_str());
+      fprintf(cpp, "%s  v = %s;\n%s}\n", indent.c_str(), readValue(f).c_str(), indent.c_str());
+    } else {
+      fprintf(cpp, "%s%s = %s;\n", indent.c_str(), f.member.c_str(), readValue(f).c_str());
+    }
+    if (f.minVersion || f.maxVersion) {
+      fprintf(cpp, "  }\n");
+    }
+  }
+  fprintf(cpp, "}\n");
+  fclose(cpp);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5) {
+    fprintf(stderr, "Usage: %s jsonfolder out.bin fields.cpp fields.h\n", argv[0]);
+    return -1;
+  }
+
+  std::filesystem::path folder = argv[1];
+  WorldInfo info;
+  std::vector<Field> fields;
+  try {
+    info.parse(folder);
+    Handle handle((folder / "header.json").string());
+    if (!handle.isOpen()) {
+      fprintf(stderr, "Missing header.json\n");
+      return -1;
+    }
+    const auto doc = JSON::parse(handle.read(handle.length));
+    for (const auto &field : *doc->root()) {
+      fields.push_back(parseField(&field));
+    }
+  } catch (JSONParseException e) {
+    fprintf(stderr, "Failed: %s\n", e.reason.c_str());
+    return -1;
+  }
+
+  if (!writeFields(fields, argv[3], argv[4])) {
+    return -1;
+  }
+
+  Writer out;
+  info.write(out);
+
+  std::filesystem::path filename = argv[2];
+  if (filename.has_parent_path()) {
+    std::filesystem::create_directories(filename.parent_path());
+  }
+  FILE *f = fopen(filename.string().c_str(), "wb");
+  if (!f) {
+    fprintf(stderr, "Failed to create %s\n", argv[2]);
+    return -1;
+  }
+  fwrite(out.data.data(), out.data.size(), 1, f);
+  fclose(f);
+  return 0;
+}
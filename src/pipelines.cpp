@@ -234,6 +234,25 @@ std::string Pipelines::init(SDL_GPUDevice *gpu) {
   pipelineInfo.vertex_input_state.vertex_attributes = flatVertexAttrs;
   pipelineInfo.vertex_input_state.num_vertex_attributes = SDL_arraysize(flatVertexAttrs);
   pipelines[Pipeline::Flat] = SDL_CreateGPUGraphicsPipeline(gpu, &pipelineInfo);
+
+  // Light is flat, but multiplies what's already been drawn
+  SDL_GPUColorTargetBlendState multiplyColor = {
+    .src_color_blendfactor = SDL_GPU_BLENDFACTOR_DST_COLOR,
+    .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ZERO,
+    .color_blend_op = SDL_GPU_BLENDOP_ADD,
+    .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ZERO,
+    .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+    .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+    .color_write_mask =
+      SDL_GPU_COLORCOMPONENT_R | SDL_GPU_COLORCOMPONENT_G |
+      SDL_GPU_COLORCOMPONENT_B | SDL_GPU_COLORCOMPONENT_A,
+    .enable_blend = true,
+  };
+  colorTarget.blend_state = multiplyColor;
+  pipelineInfo.depth_stencil_state.enable_depth_write = false;
+  pipelines[Pipeline::Light] = SDL_CreateGPUGraphicsPipeline(gpu, &pipelineInfo);
+  pipelineInfo.depth_stencil_state.enable_depth_write = true;
+  colorTarget.blend_state = opaqueColor;
   SDL_ReleaseGPUShader(gpu, vShader);
   SDL_ReleaseGPUShader(gpu, fShader);
 
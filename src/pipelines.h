@@ -7,7 +7,7 @@
 #include <SDL3/SDL_gpu.h>
 
 enum class Pipeline {
-  Tile, Background, Liquid, Flat, Hilite
+  Tile, Background, Liquid, Flat, Hilite, Light
 };
 
 struct ShaderSource {
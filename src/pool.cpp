@@ -0,0 +1,98 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "pool.h"
+#include <SDL3/SDL_cpuinfo.h>
+
+Pool::Pool(int threads, SDL_ThreadPriority priority) : numThreads(threads), priority(priority) {}
+
+Pool::~Pool() {
+  if (!mutex) {
+    return;
+  }
+  SDL_LockMutex(mutex);
+  quit = true;
+  jobs.clear();
+  SDL_BroadcastCondition(wake);
+  SDL_UnlockMutex(mutex);
+  for (auto thread : threads) {
+    SDL_WaitThread(thread, nullptr);
+  }
+  SDL_DestroyCondition(idle);
+  SDL_DestroyCondition(wake);
+  SDL_DestroyMutex(mutex);
+}
+
+void Pool::start() {
+  mutex = SDL_CreateMutex();
+  wake = SDL_CreateCondition();
+  idle = SDL_CreateCondition();
+  if (numThreads <= 0) {
+    numThreads = SDL_GetNumLogicalCPUCores();
+  }
+  for (int i = 0; i < numThreads; i++) {
+    threads.push_back(SDL_CreateThread(worker, "pool", this));
+  }
+}
+
+void Pool::add(std::function<void()> job) {
+  if (!mutex) {
+    start();
+  }
+  SDL_LockMutex(mutex);
+  jobs.push_back(std::move(job));
+  SDL_SignalCondition(wake);
+  SDL_UnlockMutex(mutex);
+}
+
+void Pool::clear() {
+  if (!mutex) {
+    return;
+  }
+  SDL_LockMutex(mutex);
+  jobs.clear();
+  if (running == 0) {
+    SDL_BroadcastCondition(idle);
+  }
+  SDL_UnlockMutex(mutex);
+}
+
+void Pool::wait() {
+  if (!mutex) {
+    return;
+  }
+  SDL_LockMutex(mutex);
+  while (!jobs.empty() || running > 0) {
+    SDL_WaitCondition(idle, mutex);
+  }
+  SDL_UnlockMutex(mutex);
+}
+
+int Pool::size() const {
+  return numThreads > 0 ? numThreads : SDL_GetNumLogicalCPUCores();
+}
+
+int Pool::worker(void *data) {
+  Pool *pool = static_cast<Pool *>(data);
+  SDL_SetCurrentThreadPriority(pool->priority);
+  SDL_LockMutex(pool->mutex);
+  while (true) {
+    while (!pool->quit && pool->jobs.empty()) {
+      SDL_WaitCondition(pool->wake, pool->mutex);
+    }
+    if (pool->quit) {
+      break;
+    }
+    auto job = std::move(pool->jobs.front());
+    pool->jobs.pop_front();
+    pool->running++;
+    SDL_UnlockMutex(pool->mutex);
+    job();
+    SDL_LockMutex(pool->mutex);
+    pool->running--;
+    if (pool->running == 0 && pool->jobs.empty()) {
+      SDL_BroadcastCondition(pool->idle);
+    }
+  }
+  SDL_UnlockMutex(pool->mutex);
+  return 0;
+}
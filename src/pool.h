@@ -0,0 +1,41 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/*
+ * A fixed set of worker threads that run queued jobs in order.
+ * Threads are started with the first job, so pools can be members of
+ * objects that are constructed before SDL is.
+ */
+class Pool {
+  public:
+    // threads <= 0 uses one thread per core
+    explicit Pool(int threads = 0, SDL_ThreadPriority priority = SDL_THREAD_PRIORITY_NORMAL);
+    ~Pool();
+    void add(std::function<void()> job);
+    // drops any jobs that haven't started yet
+    void clear();
+    // blocks until every queued job has finished
+    void wait();
+    int size() const;
+
+  private:
+    static int worker(void *data);
+    void start();
+
+    int numThreads;
+    SDL_ThreadPriority priority;
+    std::vector<SDL_Thread *> threads;
+    std::deque<std::function<void()>> jobs;
+    SDL_Mutex *mutex = nullptr;
+    SDL_Condition *wake = nullptr;
+    SDL_Condition *idle = nullptr;
+    int running = 0;
+    bool quit = false;
+};
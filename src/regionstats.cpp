@@ -0,0 +1,177 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "regionstats.h"
+#include "pool.h"
+#include "world.h"
+#include <algorithm>
+
+static bool isOre(const std::string &name) {
+  return (name.size() > 3 && name.ends_with("Ore")) || name == "Meteorite" || name == "Hellstone";
+}
+
+static const char *liquidNames[] = {"Water", "Lava", "Honey", "Shimmer"};
+static const char *wireNames[] = {"Red Wire", "Blue Wire", "Green Wire", "Yellow Wire"};
+static const uint16_t wireBits[] = {IsRedWire, IsBlueWire, IsGreenWire, IsYellowWire};
+
+template <class Fn>
+void RegionStats::tally(const Tile &tile, Fn &&add) const {
+  if (tile.active() && tile.type >= 0 && tile.type < ores.size() && ores[tile.type] >= 0) {
+    add(ores[tile.type], 1);
+  }
+  if (tile.wall > 0 && tile.wall < walls.size() && walls[tile.wall] >= 0) {
+    add(walls[tile.wall], 1);
+  }
+  if (tile.liquid > 0) {
+    int kind = tile.shimmer() ? 3 : tile.honey() ? 2 : tile.lava() ? 1 : 0;
+    add(liquids + kind, tile.liquid);
+  }
+  if (auto is = tile.Is(); is & (IsRedWire | IsBlueWire | IsGreenWire | IsYellowWire)) {
+    for (int i = 0; i < 4; i++) {
+      if (is & wireBits[i]) {
+        add(wires + i, 1);
+      }
+    }
+  }
+}
+
+uint64_t &RegionStats::sat(int category, int cx, int cy) {
+  return tables[(static_cast<size_t>(category) * (cellsHigh + 1) + cy) * (cellsWide + 1) + cx];
+}
+
+uint64_t RegionStats::sat(int category, int cx, int cy) const {
+  return tables[(static_cast<size_t>(category) * (cellsHigh + 1) + cy) * (cellsWide + 1) + cx];
+}
+
+void RegionStats::build(const World &world, Pool &pool) {
+  this->world = &world;
+  categories.clear();
+  const auto &info = world.info;
+  ores.assign(info.tiles.size(), -1);
+  for (size_t type = 0; type < info.tiles.size(); type++) {
+    if (isOre(info.tiles[type].name)) {
+      ores[type] = categories.size();
+      categories.push_back({Category::Kind::Ore, info.tiles[type].name});
+    }
+  }
+  liquids = categories.size();
+  for (auto name : liquidNames) {
+    categories.push_back({Category::Kind::Liquid, name});
+  }
+  wires = categories.size();
+  for (auto name : wireNames) {
+    categories.push_back({Category::Kind::Wire, name});
+  }
+  walls.assign(info.walls.size(), -1);
+
+  const int wide = world.tilesWide;
+  const int high = world.tilesHigh;
+  cellsWide = (wide + (1 << CellShift) - 1) >> CellShift;
+  cellsHigh = (high + (1 << CellShift) - 1) >> CellShift;
+
+  // each job is a row of cells, so no two jobs ever write to the same cell
+  std::vector<std::vector<uint8_t>> present(cellsHigh);
+  for (int cy = 0; cy < cellsHigh; cy++) {
+    pool.add([&, cy]() {
+      auto &seen = present[cy];
+      seen.assign(walls.size(), 0);
+      int end = std::min(high, (cy + 1) << CellShift);
+      for (int y = cy << CellShift; y < end; y++) {
+        const Tile *row = world.tiles + static_cast<size_t>(y) * wide;
+        for (int x = 0; x < wide; x++) {
+          if (row[x].wall > 0 && row[x].wall < seen.size()) {
+            seen[row[x].wall] = 1;
+          }
+        }
+      }
+    });
+  }
+  pool.wait();
+  // only walls that are actually in the world get a table
+  for (size_t wall = 1; wall < walls.size(); wall++) {
+    for (const auto &seen : present) {
+      if (seen[wall]) {
+        walls[wall] = categories.size();
+        categories.push_back({Category::Kind::Wall, info.walls[wall].name});
+        break;
+      }
+    }
+  }
+
+  tables.assign(categories.size() * (cellsWide + 1) * (cellsHigh + 1), 0);
+  for (int cy = 0; cy < cellsHigh; cy++) {
+    pool.add([&, cy]() {
+      int end = std::min(high, (cy + 1) << CellShift);
+      for (int y = cy << CellShift; y < end; y++) {
+        const Tile *row = world.tiles + static_cast<size_t>(y) * wide;
+        for (int x = 0; x < wide; x++) {
+          tally(row[x], [&](int category, uint64_t amount) {
+            sat(category, (x >> CellShift) + 1, cy + 1) += amount;
+          });
+        }
+      }
+    });
+  }
+  pool.wait();
+
+  // then turn each category's cell counts into its summed-area table
+  for (int category = 0; category < categories.size(); category++) {
+    pool.add([this, category]() {
+      for (int cy = 1; cy <= cellsHigh; cy++) {
+        for (int cx = 1; cx <= cellsWide; cx++) {
+          sat(category, cx, cy) += sat(category, cx - 1, cy) + sat(category, cx, cy - 1) - sat(category, cx - 1, cy - 1);
+        }
+      }
+    });
+  }
+  pool.wait();
+}
+
+std::vector<uint64_t> RegionStats::query(int x0, int y0, int x1, int y1) const {
+  std::vector<uint64_t> totals(categories.size(), 0);
+  if (world == nullptr) {
+    return totals;
+  }
+  const int wide = world->tilesWide;
+  x0 = std::clamp(x0, 0, wide);
+  x1 = std::clamp(x1, x0, wide);
+  y0 = std::clamp(y0, 0, world->tilesHigh);
+  y1 = std::clamp(y1, y0, world->tilesHigh);
+
+  // the cells entirely inside, the last cell is short if the world is
+  const int size = 1 << CellShift;
+  int cx0 = (x0 + size - 1) >> CellShift;
+  int cy0 = (y0 + size - 1) >> CellShift;
+  int cx1 = x1 == wide ? cellsWide : x1 >> CellShift;
+  int cy1 = y1 == world->tilesHigh ? cellsHigh : y1 >> CellShift;
+  int fx0 = x1, fx1 = x1, fy0 = y1, fy1 = y1;
+  if (cx0 < cx1 && cy0 < cy1) {
+    for (int category = 0; category < categories.size(); category++) {
+      totals[category] = sat(category, cx1, cy1) - sat(category, cx0, cy1) - sat(category, cx1, cy0) + sat(category, cx0, cy0);
+    }
+    fx0 = cx0 << CellShift;
+    fx1 = std::min(wide, cx1 << CellShift);
+    fy0 = cy0 << CellShift;
+    fy1 = std::min(world->tilesHigh, cy1 << CellShift);
+  }
+
+  // and the tiles around them
+  auto add = [&totals](int category, uint64_t amount) {
+    totals[category] += amount;
+  };
+  for (int y = y0; y < y1; y++) {
+    const Tile *row = world->tiles + static_cast<size_t>(y) * wide;
+    if (y >= fy0 && y < fy1) {
+      for (int x = x0; x < fx0; x++) {
+        tally(row[x], add);
+      }
+      for (int x = fx1; x < x1; x++) {
+        tally(row[x], add);
+      }
+    } else {
+      for (int x = x0; x < x1; x++) {
+        tally(row[x], add);
+      }
+    }
+  }
+  return totals;
+}
@@ -0,0 +1,50 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "tiles.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class World;
+class Pool;
+
+/*
+ * Totals of ores, walls, liquids and wires inside any rectangle of the world.
+ * Every category has a summed-area table of 32x32 tile cells, so the whole
+ * cells in a rectangle cost the same no matter how many there are, and only
+ * the tiles in the partial cells around its edge are looked at.
+ */
+class RegionStats {
+  public:
+    struct Category {
+      enum class Kind : uint8_t {
+        Ore, Wall, Liquid, Wire,
+      };
+      Kind kind;
+      // ore and wall names are item keys, liquids and wires are already readable
+      std::string name;
+    };
+    // built in parallel once the tiles have loaded
+    void build(const World &world, Pool &pool);
+    // totals for every category in tiles [x0, x1) x [y0, y1),
+    // liquids are in 255ths of a tile
+    std::vector<uint64_t> query(int x0, int y0, int x1, int y1) const;
+
+    std::vector<Category> categories;
+
+  private:
+    static const int CellShift = 5;
+    template <class Fn> void tally(const Tile &tile, Fn &&add) const;
+    uint64_t &sat(int category, int cx, int cy);
+    uint64_t sat(int category, int cx, int cy) const;
+
+    const World *world = nullptr;
+    std::vector<int> ores;   // by tile type, -1 if it isn't one
+    std::vector<int> walls;  // by wall type, -1 if it's not in the world
+    int liquids = 0, wires = 0;  // first category of each
+    int cellsWide = 0, cellsHigh = 0;
+    // one table per category, each with an extra row and column of zeros
+    std::vector<uint64_t> tables;
+};
@@ -0,0 +1,93 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "regionwin.h"
+#include "imgui.h"
+
+#include <algorithm>
+
+RegionWin::RegionWin(const World &world, const L10n &l10n) : world(world), l10n(l10n) {}
+
+void RegionWin::select(glm::ivec2 a, glm::ivec2 b) {
+  x0 = std::min(a.x, b.x);
+  y0 = std::min(a.y, b.y);
+  x1 = std::max(a.x, b.x) + 1;
+  y1 = std::max(a.y, b.y) + 1;
+  ores.clear();
+  walls.clear();
+  liquids.clear();
+  wires.clear();
+  const auto &categories = world.regions.categories;
+  const auto totals = world.regions.query(x0, y0, x1, y1);
+  for (int i = 0; i < totals.size(); i++) {
+    if (totals[i] == 0) {
+      continue;
+    }
+    const auto &category = categories[i];
+    switch (category.kind) {
+      case RegionStats::Category::Kind::Ore:
+        ores.push_back({std::string(l10n.xlateItem(category.name)), totals[i]});
+        break;
+      case RegionStats::Category::Kind::Wall:
+        walls.push_back({std::string(l10n.xlateItem(category.name)), totals[i]});
+        break;
+      case RegionStats::Category::Kind::Liquid:
+        liquids.emplace_back(category.name, totals[i]);
+        break;
+      case RegionStats::Category::Kind::Wire:
+        wires.emplace_back(category.name, totals[i]);
+        break;
+    }
+  }
+  for (auto *rows : {&ores, &walls}) {
+    std::sort(rows->begin(), rows->end(), [](const Row &a, const Row &b) {
+      if (a.amount == b.amount) {
+        return a.name < b.name;
+      }
+      return a.amount > b.amount;
+    });
+  }
+}
+
+glm::ivec2 RegionWin::topLeft() const {
+  return glm::ivec2(x0, y0);
+}
+
+glm::ivec2 RegionWin::bottomRight() const {
+  return glm::ivec2(x1, y1);
+}
+
+bool RegionWin::show() {
+  bool open = true;
+  ImGui::SetNextWindowSize(ImVec2(300, 400), ImGuiCond_Appearing);
+  if (ImGui::Begin("Region", &open)) {
+    ImGui::Text("%d,%d to %d,%d (%d x %d)", x0, y0, x1 - 1, y1 - 1, x1 - x0, y1 - y0);
+    showRows("Ores", ores, false);
+    showRows("Liquids", liquids, true);
+    showRows("Wires", wires, false);
+    showRows("Walls", walls, false);
+  }
+  ImGui::End();
+  return open;
+}
+
+void RegionWin::showRows(const char *title, const std::vector<Row> &rows, bool liquid) {
+  if (rows.empty()) {
+    return;
+  }
+  ImGui::SeparatorText(title);
+  if (ImGui::BeginTable(title, 2)) {
+    for (const auto &row : rows) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", row.name.c_str());
+      ImGui::TableNextColumn();
+      if (liquid) {
+        // liquids are stored in 255ths of a tile
+        ImGui::Text("%.1f", row.amount / 255.0);
+      } else {
+        ImGui::Text("%llu", static_cast<unsigned long long>(row.amount));
+      }
+    }
+    ImGui::EndTable();
+  }
+}
@@ -0,0 +1,33 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "world.h"
+#include "l10n.h"
+
+#include <glm/vec2.hpp>
+#include <string>
+#include <vector>
+
+class RegionWin {
+  public:
+    RegionWin(const World &world, const L10n &l10n);
+    // totals up everything between two corner tiles
+    void select(glm::ivec2 a, glm::ivec2 b);
+    glm::ivec2 topLeft() const;
+    glm::ivec2 bottomRight() const;
+    // returns false once it's been closed
+    bool show();
+
+  private:
+    struct Row {
+      std::string name;
+      uint64_t amount;
+    };
+    void showRows(const char *title, const std::vector<Row> &rows, bool liquid);
+
+    const World &world;
+    const L10n &l10n;
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    std::vector<Row> ores, walls, liquids, wires;
+};
@@ -5,6 +5,7 @@
 #include "pipelines.h"
 #include "terrafirma.h"
 #include <SDL3/SDL_gpu.h>
+#include <algorithm>
 #include <memory>
 
 static const int maxInstances = 512 * 512;
@@ -66,7 +67,7 @@ void Renderer::clear() {
   backgroundInstances.clear();
   liquidInstances.clear();
   flatInstances.clear();
-  hiliteInstances.clear();
+  lightGroup = nullptr;
 }
 
 void Renderer::addGroup(int slot, Pipeline pipeline, SDL_GPUTexture *tex, SDL_GPUSampler *sampler, glm::vec2 size, float z, size_t offset) {
@@ -205,10 +206,53 @@ void Renderer::addHouse(SDL_GPUCopyPass *copy, int slot, float x, float y, float
                              0, 0);
 }
 
-void Renderer::addHilite(SDL_GPUCopyPass *copy, float x, float y, float w, float h) {
-  glm::vec2 size(w, h);
-  addGroup(Textures::Hilite, Pipeline::Hilite, nullptr, nullptr, size, 10.0f, hiliteInstances.size());
-  hiliteInstances.emplace_back(glm::vec2(x, y), size);
+void Renderer::resetHilites(uint32_t count) {
+  numHilites = 0;
+  if (count <= hiliteCapacity) {
+    return;
+  }
+  if (hilites != nullptr) {
+    SDL_ReleaseGPUBuffer(gpu, hilites);
+  }
+  SDL_GPUBufferCreateInfo hiliteInfo {
+    .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+    .size = static_cast<uint32_t>(count * sizeof(HiliteInstance)),
+  };
+  hilites = SDL_CreateGPUBuffer(gpu, &hiliteInfo);
+  hiliteCapacity = hilites ? count : 0;
+}
+
+void Renderer::addHilites(SDL_GPUCopyPass *copy, const std::vector<HiliteInstance> &rects) {
+  uint32_t count = std::min<size_t>(rects.size(), hiliteCapacity - numHilites);
+  if (count == 0) {
+    return;
+  }
+  uint32_t len = count * sizeof(HiliteInstance);
+  SDL_GPUTransferBufferCreateInfo transferInfo {
+    .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+    .size = len,
+  };
+  auto upload = SDL_CreateGPUTransferBuffer(gpu, &transferInfo);
+  if (upload == nullptr) {
+    return;
+  }
+  void *buf = SDL_MapGPUTransferBuffer(gpu, upload, false);
+  SDL_memcpy(buf, rects.data(), len);
+  SDL_UnmapGPUTransferBuffer(gpu, upload);
+
+  SDL_GPUTransferBufferLocation source {
+    .transfer_buffer = upload,
+    .offset = 0,
+  };
+  SDL_GPUBufferRegion dest {
+    .buffer = hilites,
+    .offset = static_cast<uint32_t>(numHilites * sizeof(HiliteInstance)),
+    .size = len,
+  };
+  SDL_UploadToGPUBuffer(copy, &source, &dest, false);
+  // released once the upload is done with it
+  SDL_ReleaseGPUTransferBuffer(gpu, upload);
+  numHilites += count;
 }
 
 void Renderer::addFlat(SDL_GPUCopyPass *copy, void *data, float x, float y, float x2, float y2, uint32_t w, uint32_t h) {
@@ -228,6 +272,33 @@ void Renderer::resetFlat() {
   textures.resetFlat(gpu);
 }
 
+void Renderer::updateLight(SDL_GPUCopyPass *copy, const uint8_t *data, uint32_t w, uint32_t h, int x0, int y0, int x1, int y1) {
+  lightTex = textures.light(gpu, copy, data, w, h, x0, y0, x1, y1);
+}
+
+void Renderer::addLight(float x, float y, float x2, float y2, float z) {
+  if (lightTex == nullptr) {
+    return;
+  }
+  auto size = textures.size(Textures::Light);
+  lightGroup = std::make_shared<RenderData>();
+  lightGroup->pipeline = Pipeline::Light;
+  lightGroup->tex = lightTex;
+  lightGroup->sampler = sampler;
+  lightGroup->layer = z;
+  lightGroup->uvdims = size * 16.0f;
+  lightGroup->offsets.push_back(flatInstances.size());
+  glm::vec2 dims(x2 - x, y2 - y);
+  flatInstances.emplace_back(glm::vec2(x * 16, y * 16), dims * 16.f,
+                             glm::vec2(x, y) / size,
+                             dims / size);
+}
+
+void Renderer::resetLight() {
+  textures.resetLight(gpu);
+  lightTex = nullptr;
+}
+
 void Renderer::copy(SDL_GPUCopyPass *copy) {
   uint8_t *buf = (uint8_t*)SDL_MapGPUTransferBuffer(gpu, transfer, true);
   uint32_t offset = 0;
@@ -237,6 +308,9 @@ void Renderer::copy(SDL_GPUCopyPass *copy) {
   for (auto &d : toOverlay) {
     offset = copyGroup(copy, buf, d.second, offset);
   }
+  if (lightGroup) {
+    offset = copyGroup(copy, buf, lightGroup, offset);
+  }
   SDL_UnmapGPUTransferBuffer(gpu, transfer);
 
   SDL_GPUTransferBufferLocation source {
@@ -271,12 +345,11 @@ uint32_t Renderer::copyGroup(SDL_GPUCopyPass *copy, uint8_t *buf, std::shared_pt
       blocklen = sizeof(LiquidInstance);
       break;
     case Pipeline::Flat:
+    case Pipeline::Light:
       src = (uint8_t*)flatInstances.data();
       blocklen = sizeof(FlatInstance);
       break;
-    case Pipeline::Hilite:
-      src = (uint8_t*)hiliteInstances.data();
-      blocklen = sizeof(HiliteInstance);
+    case Pipeline::Hilite:  // they have their own buffer
       break;
   }
   for (auto i : group->offsets) {
@@ -296,6 +369,41 @@ void Renderer::render(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, cons
   for (const auto &i: toOverlay) {
     renderGroup(cmd, render, ortho, i.second);
   }
+  if (lightGroup) {
+    renderGroup(cmd, render, ortho, lightGroup);
+  }
+  if (hiliting && numHilites > 0) {
+    renderHilites(cmd, render, ortho);
+  }
+}
+
+// every highlight is drawn in one instanced call, the gpu clips what's offscreen
+void Renderer::renderHilites(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, const glm::mat4 &ortho) {
+  SDL_BindGPUGraphicsPipeline(render, pipelines.get(Pipeline::Hilite));
+  SDL_GPUBufferBinding vertexBinding = {
+    .buffer = hilites,
+    .offset = 0,
+  };
+
+  struct {
+    glm::vec2 hiliting;
+  } fub;
+  fub.hiliting.x = 1;
+  fub.hiliting.y = sin(SDL_GetTicks() * 3.14159 / 180.0) * 0.5 + 0.5;  // pulse
+
+  struct {
+    glm::mat4 ortho;
+    glm::vec2 uvdims;
+    float layer;
+  } ub;
+  ub.ortho = ortho;
+  ub.uvdims = glm::vec2(16, 16);
+  ub.layer = 10.0f;
+
+  SDL_BindGPUVertexBuffers(render, 0, &vertexBinding, 1);
+  SDL_PushGPUVertexUniformData(cmd, 0, &ub, sizeof(ub));
+  SDL_PushGPUFragmentUniformData(cmd, 0, &fub, sizeof(fub));
+  SDL_DrawGPUPrimitives(render, 4, numHilites, 0, 0);
 }
 
 void Renderer::renderGroup(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, const glm::mat4 &ortho, std::shared_ptr<RenderData> group) {
@@ -313,7 +421,8 @@ void Renderer::renderGroup(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render,
   struct {
     glm::vec2 hiliting;
   } fub;
-  fub.hiliting.x = hiliting ? 1 : 0;  // whether or not to dim everything else
+  // whether or not to dim everything else, the light map would dim it twice
+  fub.hiliting.x = hiliting && group->pipeline != Pipeline::Light ? 1 : 0;
   double unused;
   fub.hiliting.y = sin(SDL_GetTicks() * 3.14159 / 180.0) * 0.5 + 0.5;  // pulse
   
@@ -67,7 +67,15 @@ class Renderer {
     void addLiquid(SDL_GPUCopyPass *copy, int slot, int x, int y, float z, int w, int h, float v, float alpha);
     void addHouse(SDL_GPUCopyPass *copy, int slot, float x, float y, float z);
     void addFlat(SDL_GPUCopyPass *copy, void *data, float x, float y, float x2, float y2, uint32_t w, uint32_t h);
-    void addHilite(SDL_GPUCopyPass *copy, float x, float y, float w, float h);
+    // uploads the part of a w x h light map that changed
+    void updateLight(SDL_GPUCopyPass *copy, const uint8_t *data, uint32_t w, uint32_t h, int x0, int y0, int x1, int y1);
+    // darkens everything drawn under z by the light map
+    void addLight(float x, float y, float x2, float y2, float z);
+    void resetLight();
+    // highlights stay in their own buffer until the selection changes,
+    // room is made for up to count of them
+    void resetHilites(uint32_t count);
+    void addHilites(SDL_GPUCopyPass *copy, const std::vector<HiliteInstance> &rects);
     void copy(SDL_GPUCopyPass *copy);
     void render(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, const glm::mat4 &ortho);
     void hiliteBlock(bool hilite);
@@ -77,6 +85,7 @@ class Renderer {
     void addGroup(int slot, Pipeline pipeline, SDL_GPUTexture *tex, SDL_GPUSampler *sampler, glm::vec2 size, float z, size_t offset);
     uint32_t copyGroup(SDL_GPUCopyPass *copy, uint8_t *buf, std::shared_ptr<RenderData> group, uint32_t offset);
     void renderGroup(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, const glm::mat4 &ortho, std::shared_ptr<RenderData> group);
+    void renderHilites(SDL_GPUCommandBuffer *cmd, SDL_GPURenderPass *render, const glm::mat4 &ortho);
     SDL_GPUDevice *gpu;
     SDL_GPUTransferBuffer *transfer;
     SDL_GPUSampler *sampler, *bgSampler;
@@ -87,8 +96,12 @@ class Renderer {
     std::vector<BackgroundInstance> backgroundInstances;
     std::vector<LiquidInstance> liquidInstances;
     std::vector<FlatInstance> flatInstances;
-    std::vector<HiliteInstance> hiliteInstances;
     Textures textures;
     Pipelines pipelines;
+    SDL_GPUTexture *lightTex = nullptr;
+    std::shared_ptr<RenderData> lightGroup;  // drawn after everything it lights
     bool hiliting = false;
+    SDL_GPUBuffer *hilites = nullptr;
+    uint32_t hiliteCapacity = 0;
+    uint32_t numHilites = 0;
 };
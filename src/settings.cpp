@@ -205,7 +205,8 @@ void Settings::load() {
   Handle h(prefFile().string());
   if (h.isOpen()) {
     try {
-      auto data = JSON::parse(h.read(h.length));
+      auto doc = JSON::parse(h.read(h.length));
+      auto data = doc->root();
       autoDetectWorldPath = data->at(defaultSavesKey)->asBool();
       customWorldPath = data->at(pathToSavesKey)->asString();
       autoDetectTextures = data->at(defaultTexturesKey)->asBool();
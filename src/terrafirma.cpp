@@ -17,21 +17,9 @@
 
 static bool beginStatusBar();
 static void endStatusBar();
+static void worldTooltip(const WorldSummary &summary, const WorldInfo &info);
 
-struct SearchMap {
-  Map *map;
-  std::shared_ptr<TileInfo> block;
-  SDL_Mutex *mutex;
-};
-
-int searchMap(void *data) {
-  SearchMap *search = (SearchMap*)data;
-  auto status = search->map->hilite(search->block, search->mutex);
-  delete search;
-  return status ? 1 : 0;
-}
-
-Terrafirma::Terrafirma() : map(world) {}
+Terrafirma::Terrafirma() : map(world), worlds(world.info), inventory(world.info) {}
 
 void Terrafirma::init() {
   SDL_GPUDevice *gpu = gui.init();
@@ -44,6 +32,7 @@ void Terrafirma::init() {
   map.showTextures(showTextures && canShowTextures);
   map.showWires(showWires);
   map.showHouses(showHouses);
+  map.showLighting(showLighting);
   
   const auto err = map.init(gpu);
   if (!err.empty()) {
@@ -53,20 +42,15 @@ void Terrafirma::init() {
 }
 
 void Terrafirma::populateWorldMenu() {
-  worlds.clear();
-  const auto &folders = settings.worldFolders();
-  for (const auto &folder : folders) {
-    const std::filesystem::directory_iterator dir(folder);
-    for (const auto &file : dir) {
-      if (file.path().extension() == ".wld") {
-        worlds.push_back(file.path());
-      }
-    }
-  }
+  worlds.scan(settings.worldFolders());
+  inventory.refresh(settings.worldFolders());
 }
 
 void Terrafirma::run() {
   while (!processEvents()) {
+    l10n.update();
+    worlds.update();
+    inventory.update();
     if (gui.fence()) {
       continue;
     }
@@ -98,10 +82,13 @@ bool Terrafirma::processEvents() {
         if (io.WantCaptureMouse) {
           break;
         }
-        if (!dragging) {
+        if (selecting) {
+          regionWin->select(selectStart, map.mouseToTile(event.motion.x, event.motion.y));
+        } else if (!dragging) {
           float mx, my;
           SDL_GetMouseState(&mx, &my);
-          status = map.getStatus(l10n, mx, my);
+          map.getStatus(status, l10n, mx, my);
+          lastMouseTile = map.mouseToTile(mx, my);
         } else {
           map.drag(-event.motion.xrel, -event.motion.yrel);
         }
@@ -110,6 +97,16 @@ bool Terrafirma::processEvents() {
         if (io.WantCaptureMouse) {
           break;
         }
+        // shift dragging totals up what's in a rectangle instead of panning
+        if (event.button.button == SDL_BUTTON_LEFT && (SDL_GetModState() & SDL_KMOD_SHIFT) && world.loaded) {
+          if (!regionWin) {
+            regionWin = new RegionWin(world, l10n);
+          }
+          selectStart = map.mouseToTile(event.button.x, event.button.y);
+          regionWin->select(selectStart, selectStart);
+          selecting = true;
+          break;
+        }
         dragging = true;
         break;
       case SDL_EVENT_MOUSE_BUTTON_UP:
@@ -121,6 +118,7 @@ bool Terrafirma::processEvents() {
           rightClick = true;
         }
         dragging = false;
+        selecting = false;
         break;
       case SDL_EVENT_MOUSE_WHEEL:
         if (io.WantCaptureMouse) {
@@ -174,9 +172,9 @@ bool Terrafirma::renderGui() {
   bool shouldShowSettings = false;
 
   int idx = 0;
-  for (const auto &file : worlds) {
+  for (const auto &summary : worlds.worlds) {
     if (idx < 9 && ImGui::Shortcut(ImGuiMod_Ctrl | (ImGuiKey_1 + idx++), ImGuiInputFlags_RouteGlobal)) {
-      openWorld(file.string());
+      openWorld(summary.path.string());
     }
   }
   if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_O, ImGuiInputFlags_RouteGlobal)) {
@@ -188,6 +186,15 @@ bool Terrafirma::renderGui() {
   if (ImGui::Shortcut(ImGuiKey_F3, ImGuiInputFlags_RouteGlobal)) {
     map.stopHilite();
   }
+  if (ImGui::Shortcut(ImGuiKey_F4, ImGuiInputFlags_RouteGlobal)) {
+    map.jumpToHilite();
+  }
+  if (ImGui::Shortcut(ImGuiKey_F5, ImGuiInputFlags_RouteGlobal)) {
+    float mx, my;
+    SDL_GetMouseState(&mx, &my);
+    auto tile = map.mouseToTile(mx, my);
+    map.jumpToNearestHilite(tile.x, tile.y);
+  }
   if (ImGui::Shortcut(ImGuiKey_F6, ImGuiInputFlags_RouteGlobal)) {
     map.jumpToSpawn();
   }
@@ -196,13 +203,18 @@ bool Terrafirma::renderGui() {
     if (ImGui::BeginMenu("File")) {
       if (ImGui::BeginMenu("Open World")) {
         idx = 0;
-        for (const auto &file : worlds) {
+        for (const auto &summary : worlds.worlds) {
           std::string shortcut = "";
           if (idx < 9) {
             shortcut = std::string("Ctrl+") + "123456789"[idx++];
           }
-          if (ImGui::MenuItem(file.filename().string().c_str(), shortcut.c_str())) {
-            openWorld(file.string());
+          std::string label = summary.title + "##" + summary.path.string();
+          if (ImGui::MenuItem(label.c_str(), shortcut.c_str())) {
+            openWorld(summary.path.string());
+          }
+          if (ImGui::BeginItemTooltip()) {
+            worldTooltip(summary, world.info);
+            ImGui::EndTooltip();
           }
         }
         ImGui::EndMenu();
@@ -229,6 +241,10 @@ bool Terrafirma::renderGui() {
         showWires = !showWires;
         map.showWires(showWires);
       }
+      if (ImGui::MenuItem("Show Lighting", nullptr, showLighting)) {
+        showLighting = !showLighting;
+        map.showLighting(showLighting);
+      }
       ImGui::Separator();
       if (ImGui::MenuItem("Highlight Block...", "F2", false, world.loaded)) {
         shouldShowHiliteWin = true;
@@ -236,6 +252,9 @@ bool Terrafirma::renderGui() {
       if (ImGui::MenuItem("Stop Highlighting", "F3", false, world.loaded)) {
         map.stopHilite();
       }
+      if (ImGui::MenuItem("Next Highlighted Block", "F4", false, map.hiliteCount() > 0)) {
+        map.jumpToHilite();
+      }
       ImGui::Separator();
       if (ImGui::MenuItem("World Information...", "", false, world.loaded)) {
         shouldShowInfoWin = true;
@@ -258,6 +277,13 @@ bool Terrafirma::renderGui() {
       if (ImGui::MenuItem("Jump to Dungeon", "", false, world.loaded)) {
         map.jumpToDungeon();
       }
+      if (ImGui::MenuItem("Nearest Highlighted to Spawn", "", false, map.hiliteCount() > 0)) {
+        map.jumpToNearestHilite(world.header.spawnX, world.header.spawnY);
+      }
+      if (ImGui::MenuItem("Nearest Highlighted to Cursor", "F5", false, map.hiliteCount() > 0)) {
+        // the menu is in the way, so use where the cursor was on the map
+        map.jumpToNearestHilite(lastMouseTile.x, lastMouseTile.y);
+      }
       if (ImGui::BeginMenu("NPCs")) {
         map.npcMenu(l10n);
         ImGui::EndMenu();
@@ -307,32 +333,13 @@ bool Terrafirma::renderGui() {
       loadMutex = nullptr;
     }
   }
-  if (searchMutex != nullptr) {
-    bool searchOver = false;
-    SDL_LockMutex(searchMutex);
-    ImGui::SetNextWindowSize(ImVec2(300, 70));
-    ImGui::Begin("Searching...", nullptr, ImGuiWindowFlags_NoScrollbar);
-    ImGui::ProgressBar(ImGui::GetTime() * -0.2f, ImVec2(0, 0), "Searching for blocks...");
-    ImGui::End();
-    if (map.doneSearching()) {
-      searchOver = true;
-    }
-    SDL_UnlockMutex(searchMutex);
-    if (searchOver) {
-      int status;
-      SDL_WaitThread(searchThread, &status);
-      searchThread = nullptr;
-      if (!status) {
-        loadError = "Too many blocks found, halting search";
-        ImGui::OpenPopup("Error");
-      }
-      SDL_DestroyMutex(searchMutex);
-      searchMutex = nullptr;
-    }
-  }
-
   if (shouldShowHiliteWin) {
     ImGui::OpenPopup("HiliteBlock");
+    // the block index is built from translated names, so it's rebuilt when they change
+    if (hiliteWin && hiliteWin->generation != l10n.generation()) {
+      delete hiliteWin;
+      hiliteWin = nullptr;
+    }
     if (!hiliteWin) {
       hiliteWin = new HiliteWin(world, l10n);
     }
@@ -342,12 +349,7 @@ bool Terrafirma::renderGui() {
     auto h = hiliteWin->pickBlock();
     map.stopHilite();
     if (h != nullptr) {
-      searchMutex = SDL_CreateMutex();
-      SearchMap *search = new SearchMap;
-      search->map = &map;
-      search->block = h;
-      search->mutex = searchMutex;
-      searchThread = SDL_CreateThread(searchMap, "search", search);
+      map.hilite(h);
     }
     ImGui::EndPopup();
   }
@@ -363,8 +365,10 @@ bool Terrafirma::renderGui() {
 
   if (shouldShowFindChests) {
     ImGui::OpenPopup("FindChests");
+    // only worlds that changed since the last time are reread
+    inventory.refresh(settings.worldFolders());
     if (!findChests) {
-      findChests = new FindChests(world, l10n);
+      findChests = new FindChests(world, l10n, inventory);
     }
   }
 
@@ -378,8 +382,12 @@ bool Terrafirma::renderGui() {
 
   if (shouldShowInfoWin) {
     ImGui::OpenPopup("WorldInfo");
+    if (infoWin && infoWin->generation != l10n.generation()) {
+      delete infoWin;
+      infoWin = nullptr;
+    }
     if (!infoWin) {
-      infoWin = new InfoWin(world);
+      infoWin = new InfoWin(world, l10n);
     }
   }
 
@@ -388,6 +396,17 @@ bool Terrafirma::renderGui() {
     ImGui::EndPopup();
   }
 
+  if (regionWin) {
+    auto a = map.tileToScreen(regionWin->topLeft().x, regionWin->topLeft().y);
+    auto b = map.tileToScreen(regionWin->bottomRight().x, regionWin->bottomRight().y);
+    ImGui::GetBackgroundDrawList()->AddRect(ImVec2(a.x, a.y), ImVec2(b.x, b.y), IM_COL32(255, 204, 255, 255), 0.0f, 0, 2.0f);
+    if (!regionWin->show()) {
+      delete regionWin;
+      regionWin = nullptr;
+      selecting = false;
+    }
+  }
+
   if (shouldShowKillWin) {
     ImGui::OpenPopup("Kills");
     if (!killWin) {
@@ -432,27 +451,59 @@ bool Terrafirma::renderGui() {
   if (rightClick) {
     rightClick = false;
     viewChest.clear();
-    for (const auto &chest : world.chests) {
-      if ((chest.x == rightClickTile.x || chest.x + 1 == rightClickTile.x) &&
-          (chest.y == rightClickTile.y || chest.y + 1 == rightClickTile.y)) {
-        for (const auto &item : chest.items) {
+    world.objects.at(rightClickTile.x, rightClickTile.y, [&](const ObjectIndex::Object &obj) {
+      if (obj.kind == ObjectIndex::Kind::Chest) {
+        for (const auto &item : world.chests[obj.index].items) {
           if (item.stack > 0) {
             if (item.prefix.empty()) {
-              viewChest.push_back(std::to_string(item.stack) + " " + l10n.xlateItem(item.name));
+              viewChest.push_back(std::to_string(item.stack) + " ");
+              viewChest.back() += l10n.xlateItem(item.name);
             } else {
-              viewChest.push_back(std::to_string(item.stack) + " " + l10n.xlatePrefix(item.prefix) + " " + l10n.xlateItem(item.name));
+              viewChest.push_back(std::to_string(item.stack) + " ");
+              viewChest.back() += l10n.xlatePrefix(item.prefix);
+              viewChest.back() += ' ';
+              viewChest.back() += l10n.xlateItem(item.name);
             }
           }
         }
         ImGui::OpenPopup("ViewChest");
-      }
-    }
-    for (const auto &sign : world.signs) {
-      if ((sign.x == rightClickTile.x || sign.x + 1 == rightClickTile.x) &&
-          (sign.y == rightClickTile.y || sign.y + 1 == rightClickTile.y)) {
-        viewSign = sign.text;
+      } else if (obj.kind == ObjectIndex::Kind::Sign) {
+        viewSign = world.signs[obj.index].text;
         ImGui::OpenPopup("ViewSign");
       }
+    });
+    // clicking a visible wire highlights everything it's connected to
+    auto circuits = showWires ? world.circuits.at(rightClickTile.x, rightClickTile.y) : std::vector<Circuits::Circuit>();
+    if (!circuits.empty()) {
+      auto tiles = world.circuits.tiles(circuits);
+      viewCircuit.wires = 0;
+      viewCircuit.actuators = 0;
+      viewCircuit.triggers.clear();
+      for (const auto &span : tiles) {
+        viewCircuit.wires += span.len;
+        for (int y = span.y; y < span.y + span.len; y++) {
+          const auto &tile = world.tiles[y * world.tilesWide + span.x];
+          if (tile.actuator()) {
+            viewCircuit.actuators++;
+          }
+          if (!tile.active()) {
+            continue;
+          }
+          switch (tile.type) {
+            case TileLever:
+            case TilePressurePlates:
+            case TileSwitches:
+            case TileTimers:
+            case TileDetonator:
+            case TileLogicSensor:
+            case TileTealPressure:
+              viewCircuit.triggers.emplace_back(std::string(l10n.xlateItem(world.info[tile]->name)), glm::ivec2(span.x, y));
+              break;
+          }
+        }
+      }
+      map.hilite(std::move(tiles));
+      ImGui::OpenPopup("ViewCircuit");
     }
   }
 
@@ -463,6 +514,18 @@ bool Terrafirma::renderGui() {
     ImGui::EndPopup();
   }
 
+  if (ImGui::BeginPopup("ViewCircuit")) {
+    ImGui::Text("%llu wires, %llu actuators", static_cast<unsigned long long>(viewCircuit.wires),
+                static_cast<unsigned long long>(viewCircuit.actuators));
+    for (const auto &trigger : viewCircuit.triggers) {
+      auto label = trigger.first + " at " + std::to_string(trigger.second.x) + "," + std::to_string(trigger.second.y);
+      if (ImGui::Selectable(label.c_str())) {
+        map.jumpToLocation(trigger.second.x, trigger.second.y);
+      }
+    }
+    ImGui::EndPopup();
+  }
+
   if (ImGui::BeginPopup("ViewSign")) {
     ImGui::Text("%s", viewSign.c_str());
     ImGui::EndPopup();
@@ -478,6 +541,10 @@ bool Terrafirma::renderGui() {
 
   if (beginStatusBar()) {
     ImGui::Text("%s", status.c_str());
+    if (map.hiliteCount() > 0) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("%llu highlighted", static_cast<unsigned long long>(map.hiliteCount()));
+    }
     endStatusBar();
   }
 
@@ -504,6 +571,8 @@ void Terrafirma::openWorld(std::string file) {
     // world is still opening.. we should error out
     return;    
   }
+  // highlights point into the old world's block index
+  map.stopHilite();
   // force a reload of various windows
   if (findChests) {
     delete findChests;
@@ -517,6 +586,10 @@ void Terrafirma::openWorld(std::string file) {
     delete killWin;
     killWin = nullptr;
   }
+  if (regionWin) {
+    delete regionWin;
+    regionWin = nullptr;
+  }
   if (bestiary) {
     delete bestiary;
     bestiary = nullptr;
@@ -561,6 +634,76 @@ void endStatusBar() {
   ImGui::End();
 }
 
+static void worldTooltip(const WorldSummary &summary, const WorldInfo &info) {
+  ImGui::Text("%s", summary.path.filename().string().c_str());
+  if (!summary.scanned) {
+    ImGui::TextDisabled("Scanning...");
+    return;
+  }
+  if (summary.failed) {
+    ImGui::TextDisabled("Not a world we can read");
+    return;
+  }
+  ImGui::Text("Size: %s", summary.size.c_str());
+  ImGui::Text("Difficulty: %s", summary.difficulty.c_str());
+  if (!summary.seed.empty()) {
+    ImGui::Text("Seed: %s", summary.seed.c_str());
+  }
+  if (!summary.created.empty()) {
+    ImGui::Text("Created: %s", summary.created.c_str());
+  }
+  if (!summary.lastPlayed.empty()) {
+    ImGui::Text("Last Played: %s", summary.lastPlayed.c_str());
+  }
+  if (summary.tilesWide <= 0 || summary.tilesHigh <= 0) {
+    return;
+  }
+
+  const float width = 200.0f;
+  const float height = width * summary.tilesHigh / summary.tilesWide;
+  const auto pos = ImGui::GetCursorScreenPos();
+  auto *draw = ImGui::GetWindowDrawList();
+  const auto &thumb = summary.thumbnail;
+  if (!thumb.pixels.empty()) {
+    // runs of the same color share a rect
+    const float px = width / thumb.width;
+    const float py = height / thumb.height;
+    for (int y = 0; y < thumb.height; y++) {
+      const uint32_t *row = thumb.pixels.data() + y * thumb.width;
+      for (int x = 0; x < thumb.width;) {
+        int end = x + 1;
+        while (end < thumb.width && row[end] == row[x]) {
+          end++;
+        }
+        auto c = row[x];
+        draw->AddRectFilled(ImVec2(pos.x + x * px, pos.y + y * py), ImVec2(pos.x + end * px, pos.y + (y + 1) * py), IM_COL32(c >> 16, (c >> 8) & 0xff, c & 0xff, 0xff));
+        x = end;
+      }
+    }
+    ImGui::Dummy(ImVec2(width, height));
+    return;
+  }
+
+  // a cross section of the layers until the thumbnail is ready
+  const double hellLevel = summary.tilesHigh - 200;
+  const struct {
+    double top, bottom;
+    uint32_t color;
+  } layers[] = {
+    {0.0, summary.groundLevel, info.sky},
+    {summary.groundLevel, summary.rockLevel, info.earth},
+    {summary.rockLevel, hellLevel, info.rock},
+    {hellLevel, static_cast<double>(summary.tilesHigh), info.hell},
+  };
+  for (const auto &layer : layers) {
+    float top = pos.y + height * layer.top / summary.tilesHigh;
+    float bottom = pos.y + height * layer.bottom / summary.tilesHigh;
+    auto c = layer.color;
+    draw->AddRectFilled(ImVec2(pos.x, top), ImVec2(pos.x + width, bottom), IM_COL32(c >> 16, (c >> 8) & 0xff, c & 0xff, 0xff));
+  }
+  ImGui::Dummy(ImVec2(width, height));
+}
+
 void Terrafirma::openDialog() {
   IGFD::FileDialogConfig config {
     .path = ".",
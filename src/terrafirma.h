@@ -10,7 +10,10 @@
 #include "findchests.h"
 #include "infowin.h"
 #include "killwin.h"
+#include "regionwin.h"
 #include "bestiary.h"
+#include "worldlist.h"
+#include "inventory.h"
 
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL.h>
@@ -44,21 +47,30 @@ class Terrafirma {
     bool canShowTextures = false;
     bool showHouses = false;
     bool showWires = false;
-    std::vector<std::filesystem::path> worlds;
+    bool showLighting = false;
+    WorldList worlds;
+    Inventory inventory;
     InfoWin *infoWin = nullptr;
     KillWin *killWin = nullptr;
     Bestiary *bestiary = nullptr;
     HiliteWin *hiliteWin = nullptr;
+    RegionWin *regionWin = nullptr;
     FindChests *findChests = nullptr;
     std::vector<std::string> viewChest;
     std::string viewSign;
+    struct {
+      uint64_t wires = 0;
+      uint64_t actuators = 0;
+      std::vector<std::pair<std::string, glm::ivec2>> triggers;
+    } viewCircuit;
 
     bool dragging = false;
+    bool selecting = false;
+    glm::ivec2 selectStart;
     bool rightClick = false;
     glm::ivec2 rightClickTile;
+    glm::ivec2 lastMouseTile;
     SDL_Thread *loadThread = nullptr;
     SDL_Mutex *loadMutex = nullptr;
     std::string loadError;
-    SDL_Thread *searchThread = nullptr;
-    SDL_Mutex *searchMutex = nullptr;
 };
@@ -0,0 +1,85 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "textindex.h"
+#include <algorithm>
+
+std::string TextIndex::lower(std::string_view text) {
+  std::string r(text);
+  for (auto &ch : r) {
+    ch = std::tolower(static_cast<unsigned char>(ch));
+  }
+  return r;
+}
+
+uint32_t TextIndex::trigram(const char *p) {
+  return static_cast<uint8_t>(p[0]) << 16 | static_cast<uint8_t>(p[1]) << 8 | static_cast<uint8_t>(p[2]);
+}
+
+uint32_t TextIndex::add(std::string_view text) {
+  uint32_t id = strings.size();
+  strings.push_back(lower(text));
+  const auto &s = strings.back();
+  for (size_t i = 0; i + 3 <= s.length(); i++) {
+    auto &ids = postings[trigram(s.data() + i)];
+    // ids only ever grow, so this keeps postings sorted and unique
+    if (ids.empty() || ids.back() != id) {
+      ids.push_back(id);
+    }
+  }
+  return id;
+}
+
+size_t TextIndex::size() const {
+  return strings.size();
+}
+
+std::vector<uint32_t> TextIndex::find(std::string_view needle) const {
+  auto n = lower(needle);
+  std::vector<uint32_t> ids;
+  if (n.length() < 3) {
+    // too short for trigrams, but then we only have to check everything once
+    for (uint32_t id = 0; id < strings.size(); id++) {
+      if (strings[id].find(n) != std::string::npos) {
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }
+  // intersect starting with the rarest trigram
+  std::vector<const std::vector<uint32_t> *> lists;
+  for (size_t i = 0; i + 3 <= n.length(); i++) {
+    auto it = postings.find(trigram(n.data() + i));
+    if (it == postings.end()) {
+      return ids;
+    }
+    lists.push_back(&it->second);
+  }
+  std::sort(lists.begin(), lists.end(), [](auto a, auto b) {
+    return a->size() < b->size();
+  });
+  ids = *lists[0];
+  std::vector<uint32_t> next;
+  for (size_t i = 1; i < lists.size() && !ids.empty(); i++) {
+    next.clear();
+    std::set_intersection(ids.begin(), ids.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(next));
+    ids.swap(next);
+  }
+  // having every trigram doesn't mean they're in the right order
+  if (n.length() > 3) {
+    std::erase_if(ids, [&](uint32_t id) {
+      return strings[id].find(n) == std::string::npos;
+    });
+  }
+  return ids;
+}
+
+std::vector<uint32_t> TextIndex::refine(const std::vector<uint32_t> &ids, std::string_view needle) const {
+  auto n = lower(needle);
+  std::vector<uint32_t> r;
+  for (auto id : ids) {
+    if (strings[id].find(n) != std::string::npos) {
+      r.push_back(id);
+    }
+  }
+  return r;
+}
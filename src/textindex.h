@@ -0,0 +1,32 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Case insensitive substring search over a fixed list of strings.
+ * Every trigram of every string is indexed, so a search only checks the
+ * strings that have all of the needle's trigrams.
+ */
+class TextIndex {
+  public:
+    // returns the id of the new string, ids count up from 0
+    uint32_t add(std::string_view text);
+    size_t size() const;
+    // ids of every string containing needle, in order
+    std::vector<uint32_t> find(std::string_view needle) const;
+    // the subset of ids containing needle, for when a search gets longer
+    std::vector<uint32_t> refine(const std::vector<uint32_t> &ids, std::string_view needle) const;
+
+  private:
+    static std::string lower(std::string_view text);
+    static uint32_t trigram(const char *p);
+
+    std::vector<std::string> strings;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+};
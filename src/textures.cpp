@@ -140,6 +140,60 @@ void Textures::resetFlat(SDL_GPUDevice *gpu) {
   cache[Flat] = nullptr;
 }
 
+SDL_GPUTexture *Textures::light(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy, const uint8_t *data, uint32_t w, uint32_t h,
+                                uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+  auto tex = cache[Light];
+  if (!tex) {
+    SDL_GPUTextureCreateInfo info {
+      .type = SDL_GPU_TEXTURETYPE_2D,
+      .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+      .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+      .width = w,
+      .height = h,
+      .layer_count_or_depth = 1,
+      .num_levels = 1,
+    };
+    tex = SDL_CreateGPUTexture(gpu, &info);
+    cache[Light] = tex;
+    dims[Light] = glm::vec2(w, h);
+  }
+  if (tex == nullptr || x1 <= x0 || y1 <= y0) {
+    return tex;
+  }
+  uint32_t rowLen = (x1 - x0) * 4;
+  SDL_GPUTransferBufferCreateInfo transferCreateInfo {
+    .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+    .size = rowLen * (y1 - y0),
+  };
+  SDL_GPUTransferBuffer *transfer = SDL_CreateGPUTransferBuffer(gpu, &transferCreateInfo);
+  uint8_t *dest = static_cast<uint8_t *>(SDL_MapGPUTransferBuffer(gpu, transfer, true));
+  for (uint32_t y = y0; y < y1; y++, dest += rowLen) {
+    SDL_memcpy(dest, data + (static_cast<size_t>(y) * w + x0) * 4, rowLen);
+  }
+  SDL_UnmapGPUTransferBuffer(gpu, transfer);
+
+  SDL_GPUTextureTransferInfo transferInfo {
+    .transfer_buffer = transfer,
+    .offset = 0,
+  };
+  SDL_GPUTextureRegion region {
+    .texture = tex,
+    .x = x0,
+    .y = y0,
+    .w = x1 - x0,
+    .h = y1 - y0,
+    .d = 1,
+  };
+  SDL_UploadToGPUTexture(copy, &transferInfo, &region, true);
+  SDL_ReleaseGPUTransferBuffer(gpu, transfer);
+  return tex;
+}
+
+void Textures::resetLight(SDL_GPUDevice *gpu) {
+  SDL_ReleaseGPUTexture(gpu, cache[Light]);
+  cache[Light] = nullptr;
+}
+
 void Textures::load(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy, int slot, const std::string name) {
   auto path = root / (name + ".xnb");
   Handle handle(path.string());
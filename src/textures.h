@@ -14,6 +14,10 @@ class Textures {
     SDL_GPUTexture *flat(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy, void *data, uint32_t w, uint32_t h);
     glm::vec2 size(int slot);
     void resetFlat(SDL_GPUDevice *gpu);
+    // one pixel per tile like flat, but uploaded a rectangle at a time
+    SDL_GPUTexture *light(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copy, const uint8_t *data, uint32_t w, uint32_t h,
+                          uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+    void resetLight(SDL_GPUDevice *gpu);
 
     enum TextureSlot {
       Tile = 0x1000,
@@ -39,6 +43,7 @@ class Textures {
       Banner = 4,
       Flat = 5,
       Hilite = 6,
+      Light = 7,
     };
 
   private:
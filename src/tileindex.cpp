@@ -0,0 +1,44 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "tileindex.h"
+
+void TileIndex::reset(const WorldInfo &info) {
+  this->info = &info;
+  spans.clear();
+  // plus one for unknown types
+  spans.resize(info.tiles.size() + info.variants.size() + 1);
+  counts.assign(spans.size(), 0);
+}
+
+uint32_t TileIndex::id(const TileInfo *tile) const {
+  return info->id(tile);
+}
+
+void TileIndex::add(const TileInfo *tile, int x, int y, int len) {
+  auto i = id(tile);
+  auto &runs = spans[i];
+  counts[i] += len;
+  // tiles that differ only in uv still make one run
+  if (!runs.empty()) {
+    auto &last = runs.back();
+    if (last.x == x && last.y + last.len == y) {
+      last.len += len;
+      return;
+    }
+  }
+  runs.push_back({static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(len)});
+}
+
+std::span<const TileIndex::Span> TileIndex::find(const TileInfo *tile) const {
+  if (info == nullptr || tile == nullptr) {
+    return {};
+  }
+  return spans[id(tile)];
+}
+
+uint64_t TileIndex::count(const TileInfo *tile) const {
+  if (info == nullptr || tile == nullptr) {
+    return 0;
+  }
+  return counts[id(tile)];
+}
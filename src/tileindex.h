@@ -0,0 +1,33 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "worldinfo.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ * Where every kind of block is in the world.  It's filled in while the tiles
+ * load, which happens a column at a time, so each block is kept as vertical
+ * runs sorted by x then y.
+ */
+class TileIndex {
+  public:
+    struct Span {
+      uint16_t x, y, len;
+    };
+    void reset(const WorldInfo &info);
+    // must be called in load order, rle'd tiles are a single call
+    void add(const TileInfo *tile, int x, int y, int len);
+    std::span<const Span> find(const TileInfo *tile) const;
+    // number of tiles that are this exact block
+    uint64_t count(const TileInfo *tile) const;
+
+  private:
+    uint32_t id(const TileInfo *tile) const;
+
+    const WorldInfo *info = nullptr;
+    std::vector<std::vector<Span>> spans;
+    std::vector<uint64_t> counts;
+};
@@ -15,7 +15,7 @@ int Tile::load(std::shared_ptr<Handle> handle, const std::vector<bool> &extra) {
     if (flags1.tile16) {
       type |= handle->r8() << 8;
     }
-    if (extra[type]) {
+    if (type < extra.size() && extra[type]) {
       u = handle->r16();
       v = handle->r16();
     } else {
@@ -71,6 +71,12 @@ int Tile::load(std::shared_ptr<Handle> handle, const std::vector<bool> &extra) {
   if (flags3.inactive) {
     is |= IsInactive;
   }
+  if (flags4.glowing) {
+    is |= IsGlowing;
+  }
+  if (flags4.transparent) {
+    is |= IsClear;
+  }
   if (flags3.wall16) {
     // has to be after liquid since we read a byte
     wall |= handle->r8() << 8;
@@ -34,7 +34,10 @@ enum TileType {
   TilePearlSand = 116,
   TileDiscoBall = 126,
   TileCrystals = 129,
+  TileLever = 132,
+  TilePressurePlates = 135,
   TileSwitches = 136,
+  TileTimers = 144,
   TileSnow = 147,
   TileXmasTree = 171,
   TileMoss = 184,
@@ -58,9 +61,11 @@ enum TileType {
   TileTrapDoor = 386,
   TileTrapDoorClose = 387,
   TileItemFrame = 395,
+  TileDetonator = 411,
   TileManipulator = 412,
   TileConveyorR = 421,
   TileConveyorL = 422,
+  TileLogicSensor = 423,
   TileJunction = 424,
   TilePixel = 445,
   TileTealPressure = 442,
@@ -105,6 +110,8 @@ enum Is : uint16_t {
   IsActuator   = 0x0100,
   IsInactive   = 0x0200,
   IsHalf       = 0x1000,
+  IsGlowing    = 0x2000,  // illuminant coating
+  IsClear      = 0x4000,  // echo coating, lets light through
   IsSeen       = 0x8000,
 };
 
@@ -142,10 +149,27 @@ struct TileFlags4 {
   bool glowingWall : 1;  // 10
 };
 
+// how much of the wall behind a tile shows, worked out once after loading
+enum Occlusion : uint8_t {
+  Opaque  = 0x1,  // the tile is drawn as a full, solid block
+  Covered = 0x2,  // so are all its neighbors, which hides the whole wall sprite
+};
+
+// how liquid is drawn on a tile, worked out once after loading
+struct LiquidCell {
+  uint16_t shape : 5;  // edge mask, or how far below the top a body of liquid starts
+  uint16_t level : 4;  // how far below the top the liquid beside an edge starts
+  uint16_t kind : 2;  // water, lava, honey, shimmer
+  uint16_t calm : 1;  // no ripple on top
+  uint16_t body : 1;  // the tile is full of liquid, otherwise it's the edge of a solid tile
+};
+
 class Tile {
   public:
     int16_t u, v, wallu, wallv, type, wall;
     uint8_t liquid, paint, wallPaint, slope;
+    // the most bytes a single tile takes in a world file, rle included
+    static const int MaxSize = 17;
     int load(std::shared_ptr<Handle> handle, const std::vector<bool> &extra);
     uint16_t Is() const;
     bool active() const;
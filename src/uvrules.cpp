@@ -760,7 +760,7 @@ void UVRules::mapWall(const class World &world, int x, int y) {
 
   int set = (rand() % 3) * 2;
   int wall = world.tiles[offset].wall;
-  switch (world.info.walls.at(wall)->large) {
+  switch (world.info.wall(wall)->large) {
     case 1:
       set = (phlebasTiles[y % 4][x % 3] - 1) * 2;
       break;
@@ -2,11 +2,30 @@
 
 #include "world.h"
 #include "handle.h"
+#include "tables.h"
 #include <string>
 #include <vector>
 #include <cstring>
 
 
+World::World() {
+  // tables are packed from assets/jsons at build time, handle never writes to them
+  Handle handle(const_cast<uint8_t *>(tables_bin), tables_bin_length);
+  info.read(handle);
+
+  // any json files in the user's assets folder override the packed tables
+  char *prefdir = SDL_GetPrefPath("seancode", "terrafirma");
+  std::filesystem::path assets = prefdir;
+  SDL_free(prefdir);
+  assets /= "assets";
+  try {
+    info.parse(assets);
+  } catch (JSONParseException e) {
+    SDL_Log("Failed: %s", e.reason.c_str());
+    exit(-1);
+  }
+}
+
 bool World::load(const std::string &filename, SDL_Mutex *mutex) {
   loaded = false;
   failed = false;
@@ -19,64 +38,50 @@ bool World::load(const std::string &filename, SDL_Mutex *mutex) {
     return false;
   }
 
-  auto version = handle->r32();
-  setProgress("Loading map version " + std::to_string(version), mutex);
-  if (version > MaxVersion) {
-    setProgress("Unsupported map version: " + std::to_string(version), mutex);
-    return false;
-  }
-  if (version < MinVersion) {
-    setProgress("Map version too old", mutex);
+  WorldPreamble preamble;
+  if (!preamble.load(*handle)) {
+    setProgress(preamble.error, mutex);
     return false;
   }
+  auto version = preamble.version;
+  const auto &sections = preamble.sections;
+  setProgress("Loading map version " + std::to_string(version), mutex);
 
-  if (version >= 135) {
-    auto magic = handle->read(7);
-    if (magic != "relogic") {
-      setProgress("Not a terraria map file", mutex);
-      return false;
-    }
-    auto type = handle->r8();
-    if (type != 2) {
-      setProgress("Not a terraria map file", mutex);
-      return false;
-    }
-    handle->skip(4 + 8);  // revision & favorites
-  }
-  int numSections = handle->r16();
-  std::vector<int> sections;
-  for (int i = 0; i < numSections; i++) {
-    sections.push_back(handle->r32());
-  }
-  int numTiles = handle->r16();
-  uint8_t mask = 0x80;
-  uint8_t bits = 0;
-  std::vector<bool> extra;
-  for (int i = 0; i < numTiles; i++) {
-    if (mask == 0x80) {
-      bits = handle->r8();
-      mask = 1;
-    } else {
-      mask <<= 1;
-    }
-    extra.push_back(bits & mask);
-  }
+  const auto decode = decoders(version);
 
   setProgress("Loading header", mutex);
   handle->seek(sections[0]);
-  loadHeader(handle, version);
+  if (!loadHeader(handle, version)) {
+    setProgress("Corrupt world header", mutex);
+    return false;
+  }
   setProgress("Loading tiles", mutex);
   handle->seek(sections[1]);
-  loadTiles(handle, version, extra);
+  loadTiles(handle, version, preamble.extra);
+  if (handle->overrun) {
+    setProgress("World file is truncated", mutex);
+    return false;
+  }
+  setProgress("Counting resources", mutex);
+  regions.build(*this, pool);
+  census.build(*this, groundLevel, rockLevel, hellLevel, pool);
+  setProgress("Tracing wires", mutex);
+  circuits.build(*this, pool);
+  wireMasks.assign(static_cast<size_t>(tilesWide) * tilesHigh, 0);
+  maskWires(0, 0, tilesWide, tilesHigh);
+  liquidCells.assign(static_cast<size_t>(tilesWide) * tilesHigh, LiquidCell());
+  classifyLiquids(0, 0, tilesWide, tilesHigh);
+  occlusion.assign(static_cast<size_t>(tilesWide) * tilesHigh, 0);
+  occludeWalls(0, 0, tilesWide, tilesHigh);
   setProgress("Loading chests", mutex);
   handle->seek(sections[2]);
-  loadChests(handle, version);
+  decode.chests(handle, info, chests);
   setProgress("Loading signs", mutex);
   handle->seek(sections[3]);
   loadSigns(handle);
   setProgress("Loading npcs", mutex);
   handle->seek(sections[4]);
-  loadNPCs(handle, version);
+  (this->*decode.npcs)(handle);
   setProgress("Loading entities", mutex);
   handle->seek(sections[5]);
   if (version >= 116) {
@@ -103,12 +108,13 @@ bool World::load(const std::string &filename, SDL_Mutex *mutex) {
   if (version >= 220) {
     // section 9 is creative powers
   }
+  indexObjects();
+  // light is spread a region at a time, as it's shown
+  light.reset(tilesWide, tilesHigh);
 
   loaded = true;
 
   setProgress("Done", mutex);
-
-  // we would spread light here
   return true;
 }
 
@@ -122,18 +128,22 @@ std::string World::progress() {
   return loadProgress;
 }
 
-void World::loadHeader(std::shared_ptr<Handle> handle, int version) {
+bool World::loadHeader(std::shared_ptr<Handle> handle, int version) {
   header.load(handle, version);
-  tilesHigh = header["tilesHigh"]->toInt();
-  tilesWide = header["tilesWide"]->toInt();
+  if (handle->overrun || header.tilesWide <= 0 || header.tilesHigh <= 0) {
+    return false;
+  }
+  tilesHigh = header.tilesHigh;
+  tilesWide = header.tilesWide;
 
-  groundLevel = header["groundLevel"]->toInt();
-  rockLevel = header["rockLevel"]->toInt();
-  hellLevel = ((tilesHigh - 330) - groundLevel) / 6;
-  hellLevel = hellLevel * 6 + groundLevel - 5;
+  groundLevel = header.groundLevel;
+  rockLevel = header.rockLevel;
+  hellLevel = header.hellLevel();
 
   tiles = new Tile[tilesWide * tilesHigh]();  // () = init to zero
   colors = new uint8_t[tilesWide * tilesHigh * 4];
+  blocks.reset(info);
+  return true;
 }
 
 void World::loadTiles(std::shared_ptr<Handle> handle, int version, std::vector<bool> &extra) {
@@ -142,6 +152,9 @@ void World::loadTiles(std::shared_ptr<Handle> handle, int version, std::vector<b
     for (int y = 0; y < tilesHigh; y++) {
       int rle = tiles[offset].load(handle, extra);
       mapColor(tiles[offset], colors + offset * 4, y);  // calculate now so we can take advantage of rle
+      if (tiles[offset].active()) {
+        blocks.add(info[tiles[offset]], x, y, rle + 1);
+      }
       int destOffset = offset + tilesWide;
       for (int r = 0; r < rle; r++, destOffset += tilesWide) {
         memcpy(&tiles[destOffset], &tiles[offset], sizeof(Tile));
@@ -153,25 +166,65 @@ void World::loadTiles(std::shared_ptr<Handle> handle, int version, std::vector<b
   }
 }
 
-void World::loadChests(std::shared_ptr<Handle> handle, int version) {
+template <int Version>
+World::Decoders World::decodersFor() {
+  return {
+    .chests = &World::loadChests<Version>,
+    .npcs = &World::loadNPCs<Version>,
+  };
+}
+
+// one band for every version the chest and npc sections change at
+World::Decoders World::decoders(int version) {
+  if (version >= 315) {
+    return decodersFor<315>();
+  }
+  if (version >= 294) {
+    return decodersFor<294>();
+  }
+  if (version >= 268) {
+    return decodersFor<268>();
+  }
+  if (version >= 213) {
+    return decodersFor<213>();
+  }
+  if (version >= 190) {
+    return decodersFor<190>();
+  }
+  if (version >= 140) {
+    return decodersFor<140>();
+  }
+  return decodersFor<MinVersion>();
+}
+
+void World::readChests(std::shared_ptr<Handle> handle, int version, const WorldInfo &info, std::vector<Chest> &chests) {
+  decoders(version).chests(handle, info, chests);
+}
+
+template <int Version>
+void World::loadChests(std::shared_ptr<Handle> handle, const WorldInfo &info, std::vector<Chest> &chests) {
   chests.clear();
   int numChests = handle->r16();
-  int itemsPerChest = version < 294 ? handle->r16() : 0;
-  for (int i = 0; i < numChests; i++) {
+  int itemsPerChest = 0;
+  if constexpr (Version < 294) {
+    itemsPerChest = handle->r16();
+  }
+  // a corrupt section stops at the end of the handle instead of counting on
+  for (int i = 0; i < numChests && !handle->overrun; i++) {
     Chest chest;
     chest.x = handle->r32();
     chest.y = handle->r32();
     chest.name = handle->rs();
-    if (version >= 294) {
+    if constexpr (Version >= 294) {
       itemsPerChest = handle->r32();
     }
-    for (int j = 0; j < itemsPerChest; j++) {
+    for (int j = 0; j < itemsPerChest && !handle->overrun; j++) {
       int stack = handle->r16();
       if (stack > 0) {
         Chest::Item item;
         item.stack = stack;
-        item.name = info.items[handle->r32()];
-        item.prefix = info.prefixes[handle->r8()];
+        item.name = info.item(handle->r32());
+        item.prefix = info.prefix(handle->r8());
         chest.items.push_back(item);
       }
     }
@@ -192,11 +245,12 @@ void World::loadSigns(std::shared_ptr<Handle> handle) {
   }
 }
 
-void World::loadNPCs(std::shared_ptr<Handle> handle, int version) {
+template <int Version>
+void World::loadNPCs(std::shared_ptr<Handle> handle) {
   npcs.clear();
   shimmered.clear();
 
-  if (version >= 268) {
+  if constexpr (Version >= 268) {
     int num = handle->r32();
     for (int i = 0; i < num; i++) {
       shimmered[handle->r32()] = true;
@@ -206,11 +260,11 @@ void World::loadNPCs(std::shared_ptr<Handle> handle, int version) {
     NPC npc;
     npc.head = 0;
     npc.sprite = 0;
-    if (version >= 190) {
+    if constexpr (Version >= 190) {
       npc.sprite = handle->r32();
-      if (const auto &child = info.npcsById.find(npc.sprite); child != info.npcsById.end()) {
-        npc.head = child->second->head;
-        npc.title = child->second->title;
+      if (const auto child = info.npcById(npc.sprite)) {
+        npc.head = child->head;
+        npc.title = child->title;
       }
     } else {
       npc.title = handle->rs();
@@ -225,21 +279,23 @@ void World::loadNPCs(std::shared_ptr<Handle> handle, int version) {
     npc.homeless = handle->r8();
     npc.homeX = handle->r32();
     npc.homeY = handle->r32();
-    if (version >= 213 && handle->r8()) {
-      npc.townVariation = handle->r32();
+    if constexpr (Version >= 213) {
+      if (handle->r8()) {
+        npc.townVariation = handle->r32();
+      }
     }
-    if (version >= 315) {
+    if constexpr (Version >= 315) {
       npc.homelessDespawn = handle->r8();
     }
     npcs.push_back(npc);
   }
-  if (version >= 140) {
+  if constexpr (Version >= 140) {
     while (handle->r8()) {
       NPC npc;
-      if (version >= 190) {
+      if constexpr (Version >= 190) {
         npc.sprite = handle->r32();
-        if (const auto &child = info.npcsById.find(npc.sprite); child != info.npcsById.end()) {
-          npc.title = child->second->title;
+        if (const auto child = info.npcById(npc.sprite)) {
+          npc.title = child->title;
         }
       } else {
         npc.title = handle->rs();
@@ -390,6 +446,220 @@ void World::loadEntities(std::shared_ptr<Handle> handle) {
   }
 }
 
+// spreads 4 bits out to the bottom of each nibble
+static const uint16_t nibbles[16] = {
+  0x0000, 0x0001, 0x0010, 0x0011, 0x0100, 0x0101, 0x0110, 0x0111,
+  0x1000, 0x1001, 0x1010, 0x1011, 0x1100, 0x1101, 0x1110, 0x1111,
+};
+
+void World::maskWires(int x0, int y0, int x1, int y1) {
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, tilesWide);
+  y1 = std::min(y1, tilesHigh);
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+  // the wire colors of a tile, red in the lowest bit
+  auto wires = [this](size_t offset) {
+    return (tiles[offset].Is() >> 4) & 0xf;
+  };
+  int jobs = pool.size();
+  for (int job = 0; job < jobs; job++) {
+    pool.add([=, this]() {
+      int start = y0 + static_cast<int64_t>(y1 - y0) * job / jobs;
+      int end = y0 + static_cast<int64_t>(y1 - y0) * (job + 1) / jobs;
+      for (int y = start; y < end; y++) {
+        size_t offset = static_cast<size_t>(y) * tilesWide + x0;
+        for (int x = x0; x < x1; x++, offset++) {
+          int here = wires(offset);
+          if (!here) {
+            wireMasks[offset] = 0;
+            continue;
+          }
+          int up = y > 0 ? wires(offset - tilesWide) : 0;
+          int right = x < tilesWide - 1 ? wires(offset + 1) : 0;
+          int down = y < tilesHigh - 1 ? wires(offset + tilesWide) : 0;
+          int left = x > 0 ? wires(offset - 1) : 0;
+          wireMasks[offset] = nibbles[here & up] | nibbles[here & right] << 1 |
+            nibbles[here & down] << 2 | nibbles[here & left] << 3;
+        }
+      }
+    });
+  }
+  pool.wait();
+}
+
+// water, lava, honey, shimmer
+static int liquidKind(const Tile &tile) {
+  return tile.shimmer() ? 3 : tile.honey() ? 2 : tile.lava() ? 1 : 0;
+}
+
+void World::classifyLiquids(int x0, int y0, int x1, int y1) {
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, tilesWide);
+  y1 = std::min(y1, tilesHigh);
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+  const int stride = tilesWide;
+  int jobs = pool.size();
+  for (int job = 0; job < jobs; job++) {
+    pool.add([=, this]() {
+      int start = y0 + static_cast<int64_t>(y1 - y0) * job / jobs;
+      int end = y0 + static_cast<int64_t>(y1 - y0) * (job + 1) / jobs;
+      for (int y = start; y < end; y++) {
+        size_t offset = static_cast<size_t>(y) * stride + x0;
+        for (int x = x0; x < x1; x++, offset++) {
+          const auto &tile = tiles[offset];
+          LiquidCell cell{};
+          bool solid = tile.active() && info[tile]->solid;
+          if (solid && !tile.inactive() && x > 0 && y > 0 && x < tilesWide - 1 && y < tilesHigh - 1) {
+            // liquid shows behind the sides of solid tiles that touch it
+            const auto &right = tiles[offset + 1];
+            const auto &left = tiles[offset - 1];
+            const auto &up = tiles[offset - stride];
+            const auto &down = tiles[offset + stride];
+            uint8_t sideLevel = 0;
+            int mask = 0;
+            int kind = 0;
+            bool calm = true;
+            if (left.liquid > 0 && tile.slope != 1 && tile.slope != 3) {
+              sideLevel = left.liquid;
+              mask |= 8;
+              kind = liquidKind(left) ? liquidKind(left) : kind;
+            }
+            if (right.liquid > 0 && tile.slope != 2 && tile.slope != 4) {
+              sideLevel = std::max(sideLevel, right.liquid);
+              mask |= 4;
+              kind = liquidKind(right) ? liquidKind(right) : kind;
+            }
+            if (up.liquid > 0 && tile.slope != 3 && tile.slope != 4) {
+              mask |= 2;
+              kind = liquidKind(up) ? liquidKind(up) : kind;
+            } else if (!up.active() || !info[up.type]->solid || tile.slope == 3 || tile.slope == 4) {
+              calm = false;
+            }
+            if (down.liquid > 0 && tile.slope != 1 && tile.slope != 2) {
+              if (down.liquid > 240) {
+                mask |= 1;
+              }
+              kind = liquidKind(down) ? liquidKind(down) : kind;
+            }
+            if (mask) {
+              if ((mask & 0xc) && (mask & 1)) {  // down + any side is the same as both sides
+                mask |= 0xc;
+              }
+              if (tile.half() || tile.slope) {
+                mask |= 0x10;
+              }
+              cell.shape = mask;
+              cell.level = (255 - sideLevel) / 16;
+              cell.kind = kind;
+              cell.calm = calm;
+            }
+          } else if (tile.liquid > 0 && !solid) {
+            const auto &up = tiles[offset - (y > 0 ? stride : 0)];
+            cell.body = 1;
+            cell.shape = (255 - tile.liquid) / 16;
+            cell.kind = liquidKind(tile);
+            cell.calm = y > 0 && (up.liquid > 32 || (up.active() && info[up.type]->solid));
+          }
+          liquidCells[offset] = cell;
+        }
+      }
+    });
+  }
+  pool.wait();
+}
+
+void World::occludeWalls(int x0, int y0, int x1, int y1) {
+  // a wall sprite reaches halfway into every neighbor, so changing a tile
+  // can uncover the walls around it too
+  x0 = std::max(x0 - 1, 0);
+  y0 = std::max(y0 - 1, 0);
+  x1 = std::min(x1 + 1, tilesWide);
+  y1 = std::min(y1 + 1, tilesHigh);
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+  const int stride = tilesWide;
+  // anything sized or offset differently from a plain block has gaps
+  auto opaque = [this](const Tile &tile) -> uint8_t {
+    if (!tile.active() || tile.inactive() || tile.half() || tile.slope != 0 || (tile.Is() & IsClear)) {
+      return 0;
+    }
+    auto block = info[tile];
+    return block->solid && !block->transparent && block->width == 18 && block->height == 18 && block->toppad == 0 ? Opaque : 0;
+  };
+  int jobs = pool.size();
+  for (int job = 0; job < jobs; job++) {
+    pool.add([=, this]() {
+      int start = y0 + static_cast<int64_t>(y1 - y0) * job / jobs;
+      int end = y0 + static_cast<int64_t>(y1 - y0) * (job + 1) / jobs;
+      // opacity of the rows above, at and below y, with a column of padding
+      // on each side, outside the world is never opaque
+      const int w = x1 - x0 + 2;
+      std::vector<uint8_t> rows[3];
+      auto fill = [&](std::vector<uint8_t> &row, int y) {
+        row.assign(w, 0);
+        if (y < 0 || y >= tilesHigh) {
+          return;
+        }
+        const Tile *tile = tiles + static_cast<size_t>(y) * stride;
+        for (int x = std::max(x0 - 1, 0); x < std::min(x1 + 1, tilesWide); x++) {
+          row[x - x0 + 1] = opaque(tile[x]);
+        }
+      };
+      if (start < end) {
+        fill(rows[0], start - 1);
+        fill(rows[1], start);
+      }
+      for (int y = start; y < end; y++) {
+        fill(rows[2], y + 1);
+        const uint8_t *up = rows[0].data(), *at = rows[1].data(), *down = rows[2].data();
+        uint8_t *out = occlusion.data() + static_cast<size_t>(y) * stride + x0;
+        for (int i = 1; i < w - 1; i++) {
+          uint8_t all = up[i - 1] & up[i] & up[i + 1] & at[i - 1] & at[i + 1] & down[i - 1] & down[i] & down[i + 1];
+          out[i - 1] = at[i] | (at[i] & all ? Covered : 0);
+        }
+        std::swap(rows[0], rows[1]);
+        std::swap(rows[1], rows[2]);
+      }
+    });
+  }
+  pool.wait();
+}
+
+void World::indexObjects() {
+  using Kind = ObjectIndex::Kind;
+  objects.clear();
+  for (uint32_t i = 0; i < chests.size(); i++) {
+    objects.add(Kind::Chest, i, chests[i].x, chests[i].y, 2, 2);
+  }
+  for (uint32_t i = 0; i < signs.size(); i++) {
+    objects.add(Kind::Sign, i, signs[i].x, signs[i].y, 2, 2);
+  }
+  // npcs are in pixels and drawn 14 pixels above where they stand
+  for (uint32_t i = 0; i < npcs.size(); i++) {
+    objects.add(Kind::NPC, i, npcs[i].x / 16, (npcs[i].y - 14) / 16, 2, 4);
+  }
+  for (uint32_t i = 0; i < itemFrames.size(); i++) {
+    objects.add(Kind::ItemFrame, i, itemFrames[i].x, itemFrames[i].y, 2, 2);
+  }
+  for (uint32_t i = 0; i < weaponRacks.size(); i++) {
+    objects.add(Kind::WeaponRack, i, weaponRacks[i].x, weaponRacks[i].y, 3, 3);
+  }
+  for (uint32_t i = 0; i < hatRacks.size(); i++) {
+    objects.add(Kind::HatRack, i, hatRacks[i].x, hatRacks[i].y, 3, 4);
+  }
+  for (uint32_t i = 0; i < dolls.size(); i++) {
+    objects.add(Kind::Doll, i, dolls[i].x, dolls[i].y, 2, 3);
+  }
+  objects.finish(tilesWide, tilesHigh);
+}
+
 void World::loadBestiary(std::shared_ptr<Handle> handle) {
   kills.clear();
   int numKills = handle->r32();
@@ -410,46 +680,7 @@ void World::loadBestiary(std::shared_ptr<Handle> handle) {
 }
 
 void World::mapColor(const Tile &tile, uint8_t *color, int y) {
-  uint32_t c = 0;
-  if (tile.active()) {
-    c = info[tile]->color;
-  } else if (tile.wall > 0) {
-    c = info.walls[tile.wall]->color;
-  } else if (y < groundLevel) {
-    c = info.sky;
-  } else if (y < rockLevel) {
-    c = info.earth;
-  } else if (y < hellLevel) {
-    c = info.rock;
-  } else {
-    c = info.hell;
-  }
-  if (tile.liquid > 0) {
-    uint32_t lc = info.water;
-    double alpha = 0.5;
-    if (tile.shimmer()) {
-      alpha = 0.85;
-      lc = info.shimmer;
-    } else if (tile.honey()) {
-      alpha = 0.85;
-      lc = info.honey;
-    } else if (tile.lava()) {
-      alpha = 0.9;
-      lc = info.lava;
-    }
-    double r = (c >> 16) / 255.0;
-    double g = ((c >> 8) & 0xff) / 255.0;
-    double b = (c & 0xff) / 255.0;
-    double lr = (lc >> 16) / 255.0;
-    double lg = ((lc >> 8) & 0xff) / 255.0;
-    double lb = (lc & 0xff) / 255.0;
-    r = lr * alpha + r * (1. - alpha);
-    g = lg * alpha + g * (1. - alpha);
-    b = lb * alpha + b * (1. - alpha);
-    c = ((uint32_t)(r * 255) << 16) |
-            ((uint32_t)(g * 255) << 8) |
-            (uint32_t)(b * 255);
-  }
+  uint32_t c = info.mapColor(tile, y, groundLevel, rockLevel, hellLevel);
   *color++ = c >> 16;
   *color++ = (c >> 8) & 0xff;
   *color++ = c & 0xff;
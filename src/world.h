@@ -7,9 +7,17 @@
 #include "worldheader.h"
 #include "worldinfo.h"
 #include "tiles.h"
+#include "tileindex.h"
+#include "regionstats.h"
+#include "census.h"
+#include "circuits.h"
+#include "lighting.h"
+#include "objectindex.h"
+#include "pool.h"
 
 class World {
   public:
+    World();
     bool load(const std::string &filename, SDL_Mutex *mutex);
     std::string progress();
     int tilesWide, tilesHigh;
@@ -17,6 +25,18 @@ class World {
     WorldHeader header;
     Tile *tiles;
     uint8_t *colors;
+    // where each block is, for highlighting and counting them
+    TileIndex blocks;
+    // totals of resources inside any rectangle
+    RegionStats regions;
+    // how much of everything there is at each depth
+    Census census;
+    // every wire network, for highlighting whole circuits
+    Circuits circuits;
+    // in game lighting, lit as it's looked at
+    Lighting light;
+    // workers for every pass over the tiles, the load and the lighting
+    Pool pool;
     bool loaded = false;
     bool failed = false;
 
@@ -87,29 +107,56 @@ class World {
     };
 
     std::vector<DisplayDoll> dolls;
+    std::vector<ItemFrame> itemFrames;
+    std::vector<HatRack> hatRacks;
+    std::vector<WeaponsRack> weaponRacks;
     std::vector<NPC> npcs;
     std::vector<Chest> chests;
     std::vector<Sign> signs;
     std::unordered_map<std::string, int32_t> kills;
     std::vector<std::string> seen;
     std::vector<std::string> chats;
+    // everything above that has a position, for finding what's at a tile
+    ObjectIndex objects;
+    // which neighbors carry the same wire, a nibble per color from red to
+    // yellow, each with up, right, down and left in its low to high bits
+    std::vector<uint16_t> wireMasks;
+    // recomputes wireMasks inside a rectangle, call whenever wires there change
+    void maskWires(int x0, int y0, int x1, int y1);
+    // liquid and the edges of solid tiles it touches
+    std::vector<LiquidCell> liquidCells;
+    // recomputes liquidCells inside a rectangle, call whenever liquids there change
+    void classifyLiquids(int x0, int y0, int x1, int y1);
+    // Occlusion of every tile
+    std::vector<uint8_t> occlusion;
+    // recomputes occlusion inside a rectangle, call whenever tiles there change
+    void occludeWalls(int x0, int y0, int x1, int y1);
+
+    // decodes just the chest section, for indexing worlds that aren't loaded
+    static void readChests(std::shared_ptr<Handle> handle, int version, const WorldInfo &info, std::vector<Chest> &chests);
 
   private:
-    void loadHeader(std::shared_ptr<Handle> handle, int version);
+    bool loadHeader(std::shared_ptr<Handle> handle, int version);
     void loadTiles(std::shared_ptr<Handle> handle, int version, std::vector<bool> &extra);
-    void loadChests(std::shared_ptr<Handle> handle, int version);
+    template <int Version> static void loadChests(std::shared_ptr<Handle> handle, const WorldInfo &info, std::vector<Chest> &chests);
     void loadSigns(std::shared_ptr<Handle> handle);
-    void loadNPCs(std::shared_ptr<Handle> handle, int version);
+    template <int Version> void loadNPCs(std::shared_ptr<Handle> handle);
     void loadDummies(std::shared_ptr<Handle> handle);
     void loadEntities(std::shared_ptr<Handle> handle);
     void loadBestiary(std::shared_ptr<Handle> handle);
+    void indexObjects();
     void mapColor(const Tile &tile, uint8_t *color, int y);
     void render();
     void setProgress(std::string msg, SDL_Mutex *mutex);
 
-    std::vector<ItemFrame> itemFrames;
-    std::vector<HatRack> hatRacks;
-    std::vector<WeaponsRack> weaponRacks;
+    // section decoders specialized for a range of versions, picked once per file
+    struct Decoders {
+      void (*chests)(std::shared_ptr<Handle> handle, const WorldInfo &info, std::vector<Chest> &chests);
+      void (World::*npcs)(std::shared_ptr<Handle> handle);
+    };
+    template <int Version> static Decoders decodersFor();
+    static Decoders decoders(int version);
+
     std::unordered_map<uint32_t, bool> shimmered;
 
     int groundLevel, rockLevel, hellLevel;
@@ -1,206 +1,138 @@
 /** @copyright 2025 Sean Kasun */
 
 #include "worldheader.h"
-#include "assets.h"
-#include "json.h"
-#include <SDL3/SDL.h>
-#include <cassert>
-#include <memory>
+#include <type_traits>
 
-WorldHeader::WorldHeader() {
-  try {
-    const auto json = JSON::parse(header_json);
-    for (int i = 0; i < json->length(); i++) {
-      fields.push_back(Field(json->at(i)));
-    }
-    
-  } catch (JSONParseException e) {
-    SDL_Log("Failed: %s", e.reason.c_str());
-    exit(-1);
+bool WorldPreamble::load(Handle &handle) {
+  sections.clear();
+  extra.clear();
+  if (handle.length < 4) {
+    error = "Not a terraria map file";
+    return false;
   }
-}
-
-WorldHeader::~WorldHeader() = default;
-
-void WorldHeader::load(std::shared_ptr<Handle> handle, int version) {
-  data.clear();
-
-  for (const auto &field : fields) {
-    if (version >= field.minVersion && version <= field.maxVersion) {
-      auto header = std::make_shared<Header>();
-      switch (field.type) {
-        case Field::Type::BOOLEAN:
-        case Field::Type::BYTE:
-          header->setData(handle->r8());
-          break;
-        case Field::Type::INT16:
-          header->setData(handle->r16());
-          break;
-        case Field::Type::INT32:
-          header->setData(handle->r32());
-          break;
-        case Field::Type::INT64:
-          header->setData(handle->r64());
-          break;
-        case Field::Type::FLOAT32:
-          header->setData(handle->rf());
-          break;
-        case Field::Type::FLOAT64:
-          header->setData(handle->rd());
-          break;
-        case Field::Type::STRING:
-          header->setData(handle->rs());
-          break;
-        case Field::Type::ARRAY_BYTE:
-          {
-            auto num = getFieldLength(field);
-            for (int i = 0; i < num; i++) {
-              header->append(handle->r8());
-            }
-          }
-          break;
-        case Field::Type::ARRAY_INT16:
-          {
-            auto num = getFieldLength(field);
-            for (int i = 0; i < num; i++) {
-              header->append(handle->r16());
-            }
-          }
-          break;
-        case Field::Type::ARRAY_INT32:
-          {
-            auto num = getFieldLength(field);
-            for (int i = 0; i < num; i++) {
-              header->append(handle->r32());
-            }
-          }
-          break;
-        case Field::Type::ARRAY_STRING:
-          {
-            auto num = getFieldLength(field);
-            for (int i = 0; i < num; i++) {
-              header->append(handle->rs());
-            }
-          }
-          break;
-      }
-      data[field.name] = header;
-    }
+  version = handle.r32();
+  if (version > MaxVersion) {
+    error = "Unsupported map version: " + std::to_string(version);
+    return false;
   }
-}
-
-bool WorldHeader::has(const std::string &key) const {
-  return data.find(key) != data.end();
-}
-
-bool WorldHeader::is(const std::string &key) const {
-  if (!data.contains(key)) {
+  if (version < MinVersion) {
+    error = "Map version too old";
     return false;
   }
-  return data.at(key)->toInt();
-}
 
-int WorldHeader::treeStyle(int x) const {
-  const auto xs = data.at("treeX");
-  int i = 0;
-  for (; i < xs->length(); i++) {
-    if (x <= xs->at(i)->toInt()) {
-      break;
+  if (version >= 135) {
+    if (handle.length < 24) {
+      error = "Not a terraria map file";
+      return false;
+    }
+    auto magic = handle.read(7);
+    auto type = handle.r8();
+    if (magic != "relogic" || type != 2) {
+      error = "Not a terraria map file";
+      return false;
     }
+    handle.skip(4 + 8);  // revision & favorites
   }
-  int style = data.at("treeTops")->at(i)->toInt();
-  if (style) {
-    return style + 5;
+  int numSections = handle.r16();
+  if (handle.tell() + numSections * 4 + 2 > handle.length) {
+    error = "Not a terraria map file";
+    return false;
   }
-  return 0;
-}
-
-int WorldHeader::getFieldLength(const Field &f) {
-  int len = f.length;
-  if (!f.dynamicLength.empty()) {
-    if (auto child = data.find(f.dynamicLength); child != data.end()) {
-      return child->second->toInt();
+  for (int i = 0; i < numSections; i++) {
+    sections.push_back(handle.r32());
+  }
+  int numTiles = handle.r16();
+  // everything up to the bestiary is required
+  size_t required = version >= 210 ? 9 : 6;
+  if (sections.size() < required || handle.tell() + (numTiles + 7) / 8 > handle.length) {
+    error = "Not a terraria map file";
+    return false;
+  }
+  uint8_t mask = 0x80;
+  uint8_t bits = 0;
+  for (int i = 0; i < numTiles; i++) {
+    if (mask == 0x80) {
+      bits = handle.r8();
+      mask = 1;
+    } else {
+      mask <<= 1;
     }
+    extra.push_back(bits & mask);
   }
-  return len;
+  return true;
 }
 
-WorldHeader::Field::Field(std::shared_ptr<JSONData> data) {
-  name = data->at("name")->asString();
-  auto t = data->at("type")->asString();
-  if (t.empty() || t == "b") {
-    type = Type::BOOLEAN;
-  } else if (t == "s") {
-    type = (data->has("num") || data->has("relnum")) ? Type::ARRAY_STRING : Type::STRING;
-  } else if (t == "u8") {
-    type = (data->has("num") || data->has("relnum")) ? Type::ARRAY_BYTE : Type::BYTE;
-  } else if (t == "i16") {
-    type = (data->has("num") || data->has("relnum")) ? Type::ARRAY_INT16 : Type::INT16;
-  } else if (t == "i32") {
-    type = (data->has("num") || data->has("relnum")) ? Type::ARRAY_INT32 : Type::INT32;
-  } else if (t == "i64") {
-    type = Type::INT64;
-  } else if (t == "f32") {
-    type = Type::FLOAT32;
-  } else if (t == "f64") {
-    type = Type::FLOAT64;
-  } else {
-    throw JSONParseException("Invalid header type: " + t + " on " + name, "");
+// the header is only a few kilobytes, this is usually enough to avoid a second read
+const int64_t ScanSize = 64 * 1024;
+
+bool WorldHeader::scan(const std::filesystem::path &path, WorldPreamble &preamble) {
+  auto handle = std::make_unique<Handle>(path.string(), ScanSize);
+  if (!handle->isOpen() || !preamble.load(*handle)) {
+    return false;
   }
-  length = data->at("num")->asInt();
-  dynamicLength = data->at("relnum")->asString();
-  minVersion = data->at("min")->asInt();
-  maxVersion = data->at("max")->asInt();
-  if (maxVersion == 0) {
-    maxVersion = MaxVersion;
+  // the header ends where the tiles begin
+  if (preamble.sections[0] < handle->tell()) {
+    return false;
   }
-}
-
-std::shared_ptr<WorldHeader::Header> WorldHeader::operator[](const std::string &key) const {
-  if (auto child = data.find(key); child != data.end()) {
-    return child->second;
+  if (preamble.sections[1] > handle->length) {
+    handle = std::make_unique<Handle>(path.string(), preamble.sections[1]);
+    if (!handle->isOpen()) {
+      return false;
+    }
   }
-  SDL_Log("key: %s", key.c_str());
-  assert(false && "Missing key");
-}
-
-WorldHeader::Header::Header() : dint(0), ddbl(0.0) {}
-WorldHeader::Header::~Header() = default;
-
-std::shared_ptr<WorldHeader::Header> WorldHeader::Header::at(int i) const {
-  return darr.at(i);
+  return decodeSection(*handle, preamble);
 }
 
-int WorldHeader::Header::length() const {
-  return darr.size();
+bool WorldHeader::decodeSection(Handle &handle, const WorldPreamble &preamble) {
+  const auto &sections = preamble.sections;
+  if (sections[0] < 0 || sections[1] <= sections[0] || sections[1] > handle.length) {
+    return false;
+  }
+  handle.seek(sections[0]);
+  decode(handle, preamble.version);
+  return !handle.overrun;
 }
 
-int WorldHeader::Header::toInt() const {
-  return dint;
+void WorldHeader::load(std::shared_ptr<Handle> handle, int version) {
+  decode(*handle, version);
 }
 
-double WorldHeader::Header::toDouble() const {
-  return ddbl;
+bool WorldHeader::is(const std::string &key) const {
+  return toInt(key) != 0;
 }
 
-void WorldHeader::Header::setData(uint64_t v) {
-  dint = v;
-  ddbl = static_cast<double>(v);
+int WorldHeader::toInt(const std::string &key) const {
+  int r = 0;
+  visit([&](std::string_view name, const auto &value) {
+    if constexpr (std::is_arithmetic_v<std::decay_t<decltype(value)>>) {
+      if (name == key) {
+        r = value;
+      }
+    }
+  });
+  return r;
 }
 
-void WorldHeader::Header::setData(std::string s) {
-  dstr = std::move(s);
+int WorldHeader::treeStyleAt(int x) const {
+  int i = 0;
+  for (; i < treeX.size(); i++) {
+    if (x <= treeX[i]) {
+      break;
+    }
+  }
+  int style = treeTop(i);
+  if (style) {
+    return style + 5;
+  }
+  return 0;
 }
 
-void WorldHeader::Header::append(std::string s) {
-  auto h = std::make_shared<Header>();
-  h->setData(s);
-  darr.push_back(h);
+int WorldHeader::treeTop(int i) const {
+  return i >= 0 && i < treeTops.size() ? treeTops[i] : 0;
 }
 
-void WorldHeader::Header::append(uint64_t v) {
-  auto h = std::make_shared<Header>();
-  h->setData(v);
-  darr.push_back(h);
+int WorldHeader::hellLevel() const {
+  int ground = groundLevel;
+  int hell = ((tilesHigh - 330) - ground) / 6;
+  return hell * 6 + ground - 5;
 }
-
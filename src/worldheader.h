@@ -6,68 +6,41 @@ const int MinVersion = 88;
 const int MaxVersion = 318;
 
 #include "handle.h"
-#include "json.h"
-#include <vector>
-#include <unordered_map>
+#include "headerfields.h"
+#include <filesystem>
+#include <string>
 #include <memory>
+#include <vector>
 
-class WorldHeader {
+// the start of every world file, with the version and section offsets
+class WorldPreamble {
   public:
-    class Header {
-      public:
-        Header();
-        virtual ~Header();
-        int toInt() const;
-        double toDouble() const;
-        int length() const;
-        std::shared_ptr<Header> at(int i) const;
-        void setData(uint64_t v);
-        void setData(std::string s);
-        void append(uint64_t v);
-        void append(std::string s);
-      private:
-        uint64_t dint;
-        double ddbl;
-        std::string dstr;
-        std::vector<std::shared_ptr<Header>> darr;
-    };
+    // returns false and sets error if this isn't a world we can read
+    bool load(Handle &handle);
+    int version = 0;
+    std::vector<int> sections;
+    std::vector<bool> extra;  // which tiles have uvs
+    std::string error;
+};
 
-    WorldHeader();
-    virtual ~WorldHeader();
+/*
+ * The fields themselves are generated from header.json by pack,
+ * use them directly.
+ */
+class WorldHeader : public HeaderFields {
+  public:
     void load(std::shared_ptr<Handle> handle, int version);
-    bool has(const std::string &key) const;
-    std::shared_ptr<Header> operator[](const std::string &key) const;
+    // reads just the preamble and header of a world file, without any tiles
+    bool scan(const std::filesystem::path &path, WorldPreamble &preamble);
+    // decodes the header section of a file whose preamble is already loaded,
+    // false if the sections make no sense or the header runs past the handle
+    bool decodeSection(Handle &handle, const WorldPreamble &preamble);
+    // lookups by name, these are slow and only meant for the info window
     bool is(const std::string &key) const;
-    int treeStyle(int x) const;
-
-  private:
-    std::unordered_map<std::string, std::shared_ptr<Header>> data;
-
-    struct Field {
-      enum Type {
-        BOOLEAN,
-        BYTE,
-        INT16,
-        INT32,
-        INT64,
-        FLOAT32,
-        FLOAT64,
-        STRING,
-        ARRAY_BYTE,
-        ARRAY_INT16,
-        ARRAY_INT32,
-        ARRAY_STRING,
-      };
-
-      explicit Field(std::shared_ptr<JSONData> data);
-
-      std::string name;
-      Type type;
-      int length, minVersion, maxVersion;
-      std::string dynamicLength;
-    };
-
-    int getFieldLength(const Field &f);
-
-    std::vector<Field> fields;
+    int toInt(const std::string &key) const;
+    int treeStyleAt(int x) const;
+    // treeTops[i], which older worlds don't have
+    int treeTop(int i) const;
+    // where the underworld starts
+    int hellLevel() const;
 };
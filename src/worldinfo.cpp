@@ -1,14 +1,12 @@
 /** @copyright 2025 Sean Kasun */
 
 #include "worldinfo.h"
-#include "assets.h"
 #include "tiles.h"
 
-#include <SDL3/SDL.h>
 #include <memory>
 #include <cassert>
 
-static uint32_t readColor(const std::string &s) {
+static uint32_t readColor(std::string_view s) {
   uint32_t color = 0;
   for (auto c : s) {
     color <<= 4;
@@ -23,97 +21,364 @@ static uint32_t readColor(const std::string &s) {
   return color;
 }
 
-WorldInfo::WorldInfo() {
-  try {
-    // load items first so later files can reference them
-    const auto jitems = JSON::parse(items_json);
-    for (int i = 0; i < jitems->length(); i++) {
-      const auto &item = jitems->at(i);
-      items[item->at("id")->asInt()] = item->at("name")->asString();
-    }
-    const auto jtiles = JSON::parse(tiles_json);
-    for (int i = 0; i < jtiles->length(); i++) {
-      const auto &tile = jtiles->at(i);
-      tiles[tile->at("id")->asInt()] = std::make_shared<TileInfo>(tile, items);
+// counts every variant below this tile, so we can flatten them in one allocation
+static int countVariants(const JSONData *json) {
+  const auto &vars = json->at("var");
+  int num = vars->length();
+  for (int i = 0; i < vars->length(); i++) {
+    num += countVariants(vars->at(i));
+  }
+  return num;
+}
+
+// ids are small and mostly contiguous, so every table is a vector indexed by id
+template <class T>
+static T &slot(std::vector<T> &table, int id) {
+  if (id >= table.size()) {
+    table.resize(id + 1);
+  }
+  return table[id];
+}
+
+static std::shared_ptr<JSON> readJSON(const std::filesystem::path &filename) {
+  if (!std::filesystem::is_regular_file(filename)) {
+    return nullptr;
+  }
+  Handle handle(filename.string());
+  return JSON::parse(handle.read(handle.length));
+}
+
+WorldInfo::WorldInfo() = default;
+
+void WorldInfo::parse(const std::filesystem::path &folder) {
+  // load items first so later files can reference them
+  if (const auto doc = readJSON(folder / "items.json")) {
+    parseItems(doc->root());
+  }
+  if (const auto doc = readJSON(folder / "tiles.json")) {
+    parseTiles(doc->root());
+  }
+  if (const auto doc = readJSON(folder / "walls.json")) {
+    parseWalls(doc->root());
+  }
+  if (const auto doc = readJSON(folder / "prefixes.json")) {
+    parsePrefixes(doc->root());
+  }
+  if (const auto doc = readJSON(folder / "npcs.json")) {
+    parseNPCs(doc->root());
+  }
+  if (const auto doc = readJSON(folder / "globals.json")) {
+    parseGlobals(doc->root());
+  }
+}
+
+void WorldInfo::parseItems(const JSONData *jitems) {
+  items.clear();
+  for (int i = 0; i < jitems->length(); i++) {
+    const auto &item = jitems->at(i);
+    int id = item->at("id")->asInt();
+    if (id >= 0) {  // negative ids are obsolete items, they never appear in worlds
+      slot(items, id) = item->at("name")->asString();
     }
-    const auto jwalls = JSON::parse(walls_json);
-    for (int i = 0; i < jwalls->length(); i++) {
-      const auto &wall = jwalls->at(i);
-      walls[wall->at("id")->asInt()] = std::make_shared<WallInfo>(wall, items);
+  }
+}
+
+void WorldInfo::parseTiles(const JSONData *jtiles) {
+  tiles.clear();
+  variants.clear();
+  int numVariants = 0;
+  for (int i = 0; i < jtiles->length(); i++) {
+    const auto &tile = jtiles->at(i);
+    slot(tiles, tile->at("id")->asInt());
+    numVariants += countVariants(tile);
+  }
+  // reserved up front so parent references stay valid while we flatten
+  variants.reserve(numVariants);
+  std::vector<std::pair<TileInfo *, const JSONData *>> pending;
+  for (int i = 0; i < jtiles->length(); i++) {
+    const auto &tile = jtiles->at(i);
+    auto &info = tiles[tile->at("id")->asInt()];
+    info = TileInfo(tile, items);
+    pending.emplace_back(&info, tile);
+  }
+  // breadth first, so the children of every tile end up next to each other
+  for (size_t i = 0; i < pending.size(); i++) {
+    auto [parent, json] = pending[i];
+    const auto &vars = json->at("var");
+    parent->firstVariant = variants.size();
+    parent->numVariants = vars->length();
+    for (int j = 0; j < vars->length(); j++) {
+      variants.emplace_back(vars->at(j), items, *parent);
+      pending.emplace_back(&variants.back(), vars->at(j));
     }
-    const auto jprefixes = JSON::parse(prefixes_json);
-    for (int i = 0; i < jprefixes->length(); i++) {
-      const auto &prefix = jprefixes->at(i);
-      prefixes[prefix->at("id")->asInt()] = prefix->at("name")->asString();
+  }
+}
+
+void WorldInfo::parseWalls(const JSONData *jwalls) {
+  walls.clear();
+  for (int i = 0; i < jwalls->length(); i++) {
+    const auto &wall = jwalls->at(i);
+    slot(walls, wall->at("id")->asInt()) = WallInfo(wall, items);
+  }
+}
+
+void WorldInfo::parsePrefixes(const JSONData *jprefixes) {
+  prefixes.clear();
+  for (int i = 0; i < jprefixes->length(); i++) {
+    const auto &prefix = jprefixes->at(i);
+    slot(prefixes, prefix->at("id")->asInt()) = prefix->at("name")->asString();
+  }
+}
+
+void WorldInfo::parseNPCs(const JSONData *jnpcs) {
+  npcs.clear();
+  npcs.reserve(jnpcs->length());
+  for (int i = 0; i < jnpcs->length(); i++) {
+    npcs.emplace_back(jnpcs->at(i));
+  }
+  indexNPCs();
+}
+
+// npcs won't move anymore, so we can point at them
+void WorldInfo::indexNPCs() {
+  npcsById.clear();
+  npcsByBanner.clear();
+  npcsByName.clear();
+  for (int i = 0; i < npcs.size(); i++) {
+    const auto npc = &npcs[i];
+    if (npc->id >= 0) {
+      slot(npcsById, npc->id) = npc;
     }
-    const auto jnpcs = JSON::parse(npcs_json);
-    for (int i = 0; i < jnpcs->length(); i++) {
-      const auto &jnpc = jnpcs->at(i);
-      const auto npc = std::make_shared<NPC>(jnpc);
-      npcsById[jnpc->at("id")->asInt()] = npc;
-      if (jnpc->has("banner")) {
-        npcsByBanner[jnpc->at("banner")->asInt()] = npc;
-      } else if (npcsByName.find(jnpc->at("name")->asString()) == npcsByName.end()) {
-        npcsByName[jnpc->at("name")->asString()] = npc;
-      } 
+    if (npc->banner >= 0) {
+      slot(npcsByBanner, npc->banner) = npc;
+    } else if (npcsByName.find(npc->title) == npcsByName.end()) {
+      npcsByName[npc->title] = npc;
     }
-    const auto jglobals = JSON::parse(globals_json);
-    for (int i = 0; i < jglobals->length(); i++) {
-      const auto &global = jglobals->at(i);
-      const auto &kind = global->at("id")->asString();
-      const auto color = readColor(global->at("color")->asString());
-      if (kind == "sky") {
-        sky = color;
-      } else if (kind == "earth") {
-        earth = color;
-      } else if (kind == "rock") {
-        rock = color;
-      } else if (kind == "hell") {
-        hell = color;
-      } else if (kind == "water") {
-        water = color;
-      } else if (kind == "lava") {
-        lava = color;
-      } else if (kind == "honey") {
-        honey = color;
-      } else if (kind == "shimmer") {
-        shimmer = color;
-      }
+  }
+}
+
+void WorldInfo::parseGlobals(const JSONData *jglobals) {
+  for (int i = 0; i < jglobals->length(); i++) {
+    const auto &global = jglobals->at(i);
+    const auto &kind = global->at("id")->asString();
+    const auto color = readColor(global->at("color")->asString());
+    if (kind == "sky") {
+      sky = color;
+    } else if (kind == "earth") {
+      earth = color;
+    } else if (kind == "rock") {
+      rock = color;
+    } else if (kind == "hell") {
+      hell = color;
+    } else if (kind == "water") {
+      water = color;
+    } else if (kind == "lava") {
+      lava = color;
+    } else if (kind == "honey") {
+      honey = color;
+    } else if (kind == "shimmer") {
+      shimmer = color;
     }
-  } catch (JSONParseException e) {
-    SDL_Log("Failed: %s", e.reason.c_str());
-    exit(-1);
   }
 }
 
-std::shared_ptr<TileInfo> WorldInfo::operator[](Tile const &tile) const {
+/*
+ * The precompiled tables are just every table written out in order.
+ * Strings are length prefixed, the same way terraria stores them.
+ */
+void WorldInfo::read(Handle &handle) {
+  items.resize(handle.r32());
+  for (auto &item : items) {
+    item = handle.rs();
+  }
+  prefixes.resize(handle.r32());
+  for (auto &prefix : prefixes) {
+    prefix = handle.rs();
+  }
+  int numTiles = handle.r32();
+  tiles.clear();
+  tiles.reserve(numTiles);
+  for (int i = 0; i < numTiles; i++) {
+    tiles.emplace_back(handle);
+  }
+  int numVariants = handle.r32();
+  variants.clear();
+  variants.reserve(numVariants);
+  for (int i = 0; i < numVariants; i++) {
+    variants.emplace_back(handle);
+  }
+  int numWalls = handle.r32();
+  walls.clear();
+  walls.reserve(numWalls);
+  for (int i = 0; i < numWalls; i++) {
+    walls.emplace_back(handle);
+  }
+  int numNPCs = handle.r32();
+  npcs.clear();
+  npcs.reserve(numNPCs);
+  for (int i = 0; i < numNPCs; i++) {
+    npcs.emplace_back(handle);
+  }
+  indexNPCs();
+  sky = handle.r32();
+  earth = handle.r32();
+  rock = handle.r32();
+  hell = handle.r32();
+  water = handle.r32();
+  lava = handle.r32();
+  honey = handle.r32();
+  shimmer = handle.r32();
+}
+
+void WorldInfo::write(Writer &out) const {
+  out.w32(items.size());
+  for (const auto &item : items) {
+    out.ws(item);
+  }
+  out.w32(prefixes.size());
+  for (const auto &prefix : prefixes) {
+    out.ws(prefix);
+  }
+  out.w32(tiles.size());
+  for (const auto &tile : tiles) {
+    tile.write(out);
+  }
+  out.w32(variants.size());
+  for (const auto &variant : variants) {
+    variant.write(out);
+  }
+  out.w32(walls.size());
+  for (const auto &wall : walls) {
+    wall.write(out);
+  }
+  out.w32(npcs.size());
+  for (const auto &npc : npcs) {
+    npc.write(out);
+  }
+  out.w32(sky);
+  out.w32(earth);
+  out.w32(rock);
+  out.w32(hell);
+  out.w32(water);
+  out.w32(lava);
+  out.w32(honey);
+  out.w32(shimmer);
+}
+
+const TileInfo *WorldInfo::operator[](Tile const &tile) const {
   auto v = tile.v;
   if (tile.type == TileStatues) {
     v %= 162;
   }
-  return find(tiles.at(tile.type), tile.u, v);
+  return find((*this)[tile.type], tile.u, v);
 }
 
-std::shared_ptr<TileInfo> WorldInfo::operator[](int16_t type) const {
-  return tiles.at(type);
+const TileInfo *WorldInfo::operator[](int16_t type) const {
+  if (type < 0 || type >= static_cast<int>(tiles.size())) {
+    return &unknown;
+  }
+  return &tiles[type];
+}
+
+const WallInfo *WorldInfo::wall(int id) const {
+  if (id < 0 || id >= static_cast<int>(walls.size())) {
+    return &unknownWall;
+  }
+  return &walls[id];
+}
+
+uint32_t WorldInfo::id(const TileInfo *tile) const {
+  if (tile >= tiles.data() && tile < tiles.data() + tiles.size()) {
+    return tile - tiles.data();
+  }
+  if (tile >= variants.data() && tile < variants.data() + variants.size()) {
+    return tiles.size() + (tile - variants.data());
+  }
+  return tiles.size() + variants.size();
 }
 
-std::shared_ptr<TileInfo> WorldInfo::find(std::shared_ptr<TileInfo> tile, int16_t u, int16_t v) const {
-  for (const auto &var : tile->variants) {
+const TileInfo *WorldInfo::find(const TileInfo *tile, int16_t u, int16_t v) const {
+  for (const auto &var : variantsOf(tile)) {
     // must match all restrictions
-    if ((var->u < 0 || var->u == u) &&
-      (var->v < 0 || var->v == v) &&
-      (var->minu < 0 || var->minu <= u) &&
-      (var->minv < 0 || var->minv <= v) &&
-      (var->maxu < 0 || var->maxu > u) &&
-      (var->maxv < 0 || var->maxv > v)) {
-      return find(var, u, v);  // recursive
+    if ((var.u < 0 || var.u == u) &&
+      (var.v < 0 || var.v == v) &&
+      (var.minu < 0 || var.minu <= u) &&
+      (var.minv < 0 || var.minv <= v) &&
+      (var.maxu < 0 || var.maxu > u) &&
+      (var.maxv < 0 || var.maxv > v)) {
+      return find(&var, u, v);  // recursive
     }
   }
   return tile;  // no variants found
 }
 
-static TileInfo::MergeBlend parseMB(const std::string &tag, bool blend, int *offset) {
+std::span<const TileInfo> WorldInfo::variantsOf(const TileInfo *tile) const {
+  return std::span<const TileInfo>(variants.data() + tile->firstVariant, tile->numVariants);
+}
+
+static const std::string empty;
+
+uint32_t WorldInfo::mapColor(const Tile &tile, int y, int groundLevel, int rockLevel, int hellLevel) const {
+  uint32_t c = 0;
+  if (tile.active()) {
+    c = (*this)[tile]->color;
+  } else if (tile.wall > 0) {
+    c = wall(tile.wall)->color;
+  } else if (y < groundLevel) {
+    c = sky;
+  } else if (y < rockLevel) {
+    c = earth;
+  } else if (y < hellLevel) {
+    c = rock;
+  } else {
+    c = hell;
+  }
+  if (tile.liquid > 0) {
+    uint32_t lc = water;
+    double alpha = 0.5;
+    if (tile.shimmer()) {
+      alpha = 0.85;
+      lc = shimmer;
+    } else if (tile.honey()) {
+      alpha = 0.85;
+      lc = honey;
+    } else if (tile.lava()) {
+      alpha = 0.9;
+      lc = lava;
+    }
+    double r = (c >> 16) / 255.0;
+    double g = ((c >> 8) & 0xff) / 255.0;
+    double b = (c & 0xff) / 255.0;
+    double lr = (lc >> 16) / 255.0;
+    double lg = ((lc >> 8) & 0xff) / 255.0;
+    double lb = (lc & 0xff) / 255.0;
+    r = lr * alpha + r * (1. - alpha);
+    g = lg * alpha + g * (1. - alpha);
+    b = lb * alpha + b * (1. - alpha);
+    c = ((uint32_t)(r * 255) << 16) |
+            ((uint32_t)(g * 255) << 8) |
+            (uint32_t)(b * 255);
+  }
+  return c;
+}
+
+const std::string &WorldInfo::item(uint32_t id) const {
+  return id < items.size() ? items[id] : empty;
+}
+
+const std::string &WorldInfo::prefix(uint32_t id) const {
+  return id < prefixes.size() ? prefixes[id] : empty;
+}
+
+const NPC *WorldInfo::npcById(uint32_t id) const {
+  return id < npcsById.size() ? npcsById[id] : nullptr;
+}
+
+const NPC *WorldInfo::npcByBanner(uint32_t banner) const {
+  return banner < npcsByBanner.size() ? npcsByBanner[banner] : nullptr;
+}
+
+static TileInfo::MergeBlend parseMB(std::string_view tag, bool blend, int *offset) {
   std::string group = "";
   TileInfo::MergeBlend mb;
   mb.hasTile = false;
@@ -167,11 +432,16 @@ static TileInfo::MergeBlend parseMB(const std::string &tag, bool blend, int *off
   return mb;
 }
 
-TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items) {
-  static int cnt = 0;
+TileInfo::TileInfo() : color(0), lightR(0.0), lightG(0.0), lightB(0.0), mask(0),
+  solid(false), transparent(false), dirt(false), stone(false), grass(false), pile(false),
+  flip(false), brick(false), merge(false), large(false), width(18), height(18), skipy(0), toppad(0),
+  u(0), v(0), minu(0), maxu(0), minv(0), maxv(0), firstVariant(0), numVariants(0) {}
+
+// variants are flattened by WorldInfo, so these don't recurse
+TileInfo::TileInfo(const JSONData *json, const std::vector<std::string> &items) : TileInfo() {
   if (json->has("ref")) {
-    if (const auto child = items.find(json->at("ref")->asInt()); child != items.end()) {
-      name = child->second;
+    if (int ref = json->at("ref")->asInt(); ref >= 0 && ref < items.size()) {
+      name = items[ref];
     }
   } else {
     name = json->at("name")->asString();
@@ -180,18 +450,7 @@ TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint
   lightR = json->has("r") ? json->at("r")->asNumber() : 0.0;
   lightG = json->has("g") ? json->at("g")->asNumber() : 0.0;
   lightB = json->has("b") ? json->at("b")->asNumber() : 0.0;
-  mask = json->at("flags")->asInt();
-  solid = mask & 1;
-  transparent = mask & 2;
-  dirt = mask & 4;
-  stone = mask & 8;
-  grass = mask & 0x10;
-  pile = mask & 0x20;
-  flip = mask & 0x40;
-  brick = mask & 0x80;
-  //moss = mask & 0x100;
-  merge = mask & 0x200;
-  large = mask & 0x400;
+  setMask(json->at("flags")->asInt());
   u = v = minu = minv = maxu = maxv = 0;
 
   auto b = json->at("blend")->asString();
@@ -210,18 +469,12 @@ TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint
   height = json->at("h")->asInt(18);
   skipy = json->at("skipy")->asInt();
   toppad = json->at("toppad")->asInt();
-  if (json->has("var")) {
-    const auto &vars = json->at("var");
-    for (int i = 0; i < vars->length(); i++) {
-      variants.push_back(std::make_shared<TileInfo>(vars->at(i), items, *this));
-    }
-  }
 }
 
-TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items, const TileInfo &parent) {
+TileInfo::TileInfo(const JSONData *json, const std::vector<std::string> &items, const TileInfo &parent) : TileInfo() {
   if (json->has("ref")) {
-    if (const auto child = items.find(json->at("ref")->asInt()); child != items.end()) {
-      name = child->second;
+    if (int ref = json->at("ref")->asInt(); ref >= 0 && ref < items.size()) {
+      name = items[ref];
     }
   } else {
     name = json->at("name")->asString();
@@ -234,18 +487,7 @@ TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint
   lightG = json->at("g")->asNumber(parent.lightG);
   lightB = json->at("b")->asNumber(parent.lightB);
 
-  mask = parent.mask;
-
-  solid = parent.solid;
-  transparent = parent.transparent;
-  dirt = parent.dirt;
-  stone = parent.stone;
-  grass = parent.grass;
-  pile = parent.pile;
-  flip = parent.flip;
-  brick = parent.brick;
-  merge = parent.merge;
-  large = parent.large;
+  setMask(parent.mask);
 
   width = parent.width;
   height = parent.height;
@@ -258,18 +500,91 @@ TileInfo::TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint
   minv = json->at("miny")->asInt(-1) * (height + skipy);
   maxv = json->at("maxy")->asInt(-1) * (height + skipy);
 
-  if (json->has("var")) {
-    const auto &vars = json->at("var");
-    for (int i = 0; i < vars->length(); i++) {
-      variants.push_back(std::make_shared<TileInfo>(vars->at(i), items, *this));
-    }
+}
+
+TileInfo::TileInfo(Handle &handle) {
+  name = handle.rs();
+  color = handle.r32();
+  lightR = handle.rd();
+  lightG = handle.rd();
+  lightB = handle.rd();
+  setMask(handle.r32());
+  int numBlends = handle.r32();
+  for (int i = 0; i < numBlends; i++) {
+    MergeBlend mb;
+    mb.hasTile = handle.r8();
+    mb.tile = handle.r16();
+    mb.mask = handle.r32();
+    mb.blend = handle.r8();
+    mb.recursive = handle.r8();
+    mb.direction = handle.r8();
+    blends.push_back(mb);
+  }
+  width = static_cast<int32_t>(handle.r32());
+  height = static_cast<int32_t>(handle.r32());
+  skipy = static_cast<int32_t>(handle.r32());
+  toppad = static_cast<int32_t>(handle.r32());
+  u = static_cast<int32_t>(handle.r32());
+  v = static_cast<int32_t>(handle.r32());
+  minu = static_cast<int32_t>(handle.r32());
+  maxu = static_cast<int32_t>(handle.r32());
+  minv = static_cast<int32_t>(handle.r32());
+  maxv = static_cast<int32_t>(handle.r32());
+  firstVariant = handle.r32();
+  numVariants = handle.r32();
+}
+
+void TileInfo::write(Writer &out) const {
+  out.ws(name);
+  out.w32(color);
+  out.wd(lightR);
+  out.wd(lightG);
+  out.wd(lightB);
+  out.w32(mask);
+  out.w32(blends.size());
+  for (const auto &mb : blends) {
+    out.w8(mb.hasTile);
+    out.w16(mb.tile);
+    out.w32(mb.mask);
+    out.w8(mb.blend);
+    out.w8(mb.recursive);
+    out.w8(mb.direction);
   }
+  out.w32(width);
+  out.w32(height);
+  out.w32(skipy);
+  out.w32(toppad);
+  out.w32(u);
+  out.w32(v);
+  out.w32(minu);
+  out.w32(maxu);
+  out.w32(minv);
+  out.w32(maxv);
+  out.w32(firstVariant);
+  out.w32(numVariants);
 }
 
-WallInfo::WallInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items) {
+void TileInfo::setMask(uint32_t mask) {
+  this->mask = mask;
+  solid = mask & 1;
+  transparent = mask & 2;
+  dirt = mask & 4;
+  stone = mask & 8;
+  grass = mask & 0x10;
+  pile = mask & 0x20;
+  flip = mask & 0x40;
+  brick = mask & 0x80;
+  //moss = mask & 0x100;
+  merge = mask & 0x200;
+  large = mask & 0x400;
+}
+
+WallInfo::WallInfo() : color(0), blend(0) {}
+
+WallInfo::WallInfo(const JSONData *json, const std::vector<std::string> &items) {
   if (json->has("ref")) {
-    if (const auto child = items.find(json->at("ref")->asInt()); child != items.end()) {
-      name = child->second;
+    if (int ref = json->at("ref")->asInt(); ref >= 0 && ref < items.size()) {
+      name = items[ref];
     }
   } else {
     name = json->at("name")->asString();
@@ -279,8 +594,37 @@ WallInfo::WallInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint
   blend = json->at("blend")->asInt(json->at("id")->asInt());
 }
 
-NPC::NPC(std::shared_ptr<JSONData> json) {
+NPC::NPC(const JSONData *json) {
   title = json->at("name")->asString();
   head = json->at("head")->asInt();
   id = json->at("id")->asInt();
+  banner = json->at("banner")->asInt(-1);
+}
+
+WallInfo::WallInfo(Handle &handle) {
+  name = handle.rs();
+  color = handle.r32();
+  blend = handle.r16();
+  large = handle.r8();
+}
+
+void WallInfo::write(Writer &out) const {
+  out.ws(name);
+  out.w32(color);
+  out.w16(blend);
+  out.w8(large);
+}
+
+NPC::NPC(Handle &handle) {
+  title = handle.rs();
+  head = handle.r16();
+  id = handle.r16();
+  banner = handle.r16();
+}
+
+void NPC::write(Writer &out) const {
+  out.ws(title);
+  out.w16(head);
+  out.w16(id);
+  out.w16(banner);
 }
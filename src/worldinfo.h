@@ -5,8 +5,12 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <span>
+#include <vector>
+#include <filesystem>
 #include <cstdint>
 #include "json.h"
+#include "handle.h"
 
 class TileInfo {
   public:
@@ -18,8 +22,11 @@ class TileInfo {
       bool recursive;
       uint8_t direction;
     };
-    explicit TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items);
-    TileInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items, const TileInfo &parent);
+    TileInfo();
+    TileInfo(const JSONData *json, const std::vector<std::string> &items);
+    TileInfo(const JSONData *json, const std::vector<std::string> &items, const TileInfo &parent);
+    explicit TileInfo(Handle &handle);
+    void write(Writer &out) const;
     std::string name;
     uint32_t color;
     double lightR, lightG, lightB;
@@ -28,12 +35,19 @@ class TileInfo {
     std::vector<MergeBlend> blends;
     int width, height, skipy, toppad;
     int u, v, minu, maxu, minv, maxv;
-    std::vector<std::shared_ptr<TileInfo>> variants;
+    // children are stored contiguously in WorldInfo::variants
+    uint32_t firstVariant, numVariants;
+
+  private:
+    void setMask(uint32_t mask);
 };
 
 class WallInfo {
   public:
-    WallInfo(std::shared_ptr<JSONData> json, const std::unordered_map<uint16_t, std::string> &items);
+    WallInfo();
+    WallInfo(const JSONData *json, const std::vector<std::string> &items);
+    explicit WallInfo(Handle &handle);
+    void write(Writer &out) const;
     std::string name;
     uint32_t color;
     uint16_t blend;
@@ -42,25 +56,58 @@ class WallInfo {
 
 class NPC {
   public:
-    explicit NPC(std::shared_ptr<JSONData> json);
+    explicit NPC(const JSONData *json);
+    explicit NPC(Handle &handle);
+    void write(Writer &out) const;
     std::string title;
     uint16_t head;
     int16_t id;
+    int16_t banner;
 };
 
 class WorldInfo {
   public:
     WorldInfo();
-    std::shared_ptr<TileInfo> operator[](class Tile const &tile) const;
-    std::shared_ptr<TileInfo> operator[](int16_t type) const;
-    std::shared_ptr<TileInfo> find(std::shared_ptr<TileInfo> tile, int16_t u, int16_t v) const;
+    // precompiled tables, see pack.cpp
+    void read(Handle &handle);
+    void write(Writer &out) const;
+    // replaces any tables found as json files in folder
+    void parse(const std::filesystem::path &folder);
+    const TileInfo *operator[](class Tile const &tile) const;
+    const TileInfo *operator[](int16_t type) const;
+    const WallInfo *wall(int id) const;
+    const TileInfo *find(const TileInfo *tile, int16_t u, int16_t v) const;
+    // blocks and their variants share one id space, blocks first, then unknown
+    uint32_t id(const TileInfo *tile) const;
+    std::span<const TileInfo> variantsOf(const TileInfo *tile) const;
+    const std::string &item(uint32_t id) const;
+    const std::string &prefix(uint32_t id) const;
+    const NPC *npcById(uint32_t id) const;
+    const NPC *npcByBanner(uint32_t banner) const;
+    // flat 0xrrggbb color of a tile, empty tiles show the background of the layer y is in
+    uint32_t mapColor(class Tile const &tile, int y, int groundLevel, int rockLevel, int hellLevel) const;
 
-    std::unordered_map<uint16_t, std::string> items;
-    std::unordered_map<uint16_t, std::string> prefixes;
-    std::unordered_map<int16_t, std::shared_ptr<TileInfo>> tiles;
-    std::unordered_map<int16_t, std::shared_ptr<WallInfo>> walls;
-    std::unordered_map<uint16_t, std::shared_ptr<NPC>> npcsById;
-    std::unordered_map<uint16_t, std::shared_ptr<NPC>> npcsByBanner;
-    std::unordered_map<std::string, std::shared_ptr<NPC>> npcsByName;
+    // all tables are indexed directly by id, missing ids are default constructed
+    std::vector<std::string> items;
+    std::vector<std::string> prefixes;
+    std::vector<TileInfo> tiles;
+    std::vector<TileInfo> variants;
+    std::vector<WallInfo> walls;
+    std::vector<NPC> npcs;
+    std::vector<const NPC *> npcsById;
+    std::vector<const NPC *> npcsByBanner;
+    std::unordered_map<std::string, const NPC *> npcsByName;
     uint32_t sky, earth, rock, hell, water, lava, honey, shimmer;
+    // stand in for tile and wall types newer than the tables
+    TileInfo unknown;
+    WallInfo unknownWall;
+
+  private:
+    void parseItems(const JSONData *json);
+    void parseTiles(const JSONData *json);
+    void parseWalls(const JSONData *json);
+    void parsePrefixes(const JSONData *json);
+    void parseNPCs(const JSONData *json);
+    void parseGlobals(const JSONData *json);
+    void indexNPCs();
 };
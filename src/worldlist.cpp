@@ -0,0 +1,280 @@
+/** @copyright 2025 Sean Kasun */
+
+#include "worldlist.h"
+#include "worldheader.h"
+#include "tiles.h"
+#include <SDL3/SDL_filesystem.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+// thumbnails are at most this wide, tall worlds are narrower
+const int ThumbnailWidth = 160;
+// bump this whenever the cache format changes
+static const uint32_t CacheVersion = 1;
+
+WorldList::WorldList(const WorldInfo &info) : info(info) {}
+
+WorldList::~WorldList() {
+  stop();
+  if (mutex) {
+    SDL_DestroyMutex(mutex);
+  }
+}
+
+void WorldList::stop() {
+  SDL_SetAtomicInt(&cancel, 1);
+  pool.clear();
+  thumbnails.clear();
+  pool.wait();
+  thumbnails.wait();
+  SDL_SetAtomicInt(&cancel, 0);
+}
+
+void WorldList::scan(const std::vector<std::filesystem::path> &folders) {
+  if (!mutex) {
+    mutex = SDL_CreateMutex();
+  }
+  stop();
+  finished.clear();
+  finishedThumbnails.clear();
+  worlds.clear();
+  for (const auto &folder : folders) {
+    std::error_code ec;
+    for (const auto &file : std::filesystem::directory_iterator(folder, ec)) {
+      if (file.path().extension() == ".wld") {
+        WorldSummary summary;
+        summary.path = file.path();
+        summary.title = file.path().filename().string();
+        worlds.push_back(summary);
+      }
+    }
+  }
+  for (size_t i = 0; i < worlds.size(); i++) {
+    pool.add([this, i, path = worlds[i].path]() {
+      auto summary = summarize(path);
+      SDL_LockMutex(mutex);
+      finished.emplace_back(i, std::move(summary));
+      SDL_UnlockMutex(mutex);
+    });
+  }
+}
+
+void WorldList::update() {
+  if (!mutex) {
+    return;
+  }
+  SDL_LockMutex(mutex);
+  for (auto &[i, summary] : finished) {
+    worlds[i] = std::move(summary);
+    if (!worlds[i].failed && worlds[i].thumbnail.pixels.empty()) {
+      thumbnails.add([this, i, path = worlds[i].path]() {
+        Thumbnail thumbnail;
+        if (makeThumbnail(path, thumbnail)) {
+          SDL_LockMutex(mutex);
+          finishedThumbnails.emplace_back(i, std::move(thumbnail));
+          SDL_UnlockMutex(mutex);
+        }
+      });
+    }
+  }
+  finished.clear();
+  for (auto &[i, thumbnail] : finishedThumbnails) {
+    worlds[i].thumbnail = std::move(thumbnail);
+  }
+  finishedThumbnails.clear();
+  SDL_UnlockMutex(mutex);
+}
+
+static std::filesystem::path cacheFile(const std::filesystem::path &path) {
+  char *prefdir = SDL_GetPrefPath("seancode", "terrafirma");
+  std::filesystem::path dir = prefdir;
+  SDL_free(prefdir);
+  char name[32];
+  snprintf(name, sizeof(name), "%016zx.thumb", std::hash<std::string>{}(path.string()));
+  return dir / "thumbnails" / name;
+}
+
+// the cache is only valid for the exact file it came from
+static bool fileKey(const std::filesystem::path &path, uint64_t &size, uint64_t &mtime) {
+  std::error_code ec;
+  size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+  return !ec;
+}
+
+static bool readThumbnail(const std::filesystem::path &path, Thumbnail &thumbnail) {
+  uint64_t size, mtime;
+  if (!fileKey(path, size, mtime)) {
+    return false;
+  }
+  Handle handle(cacheFile(path).string());
+  if (!handle.isOpen() || handle.length < 24) {
+    return false;
+  }
+  if (handle.r32() != CacheVersion || handle.r64() != size || handle.r64() != mtime) {
+    return false;
+  }
+  int width = handle.r16();
+  int height = handle.r16();
+  if (handle.length - handle.tell() != width * height * 4) {  // truncated
+    return false;
+  }
+  thumbnail.width = width;
+  thumbnail.height = height;
+  thumbnail.pixels.resize(width * height);
+  for (auto &pixel : thumbnail.pixels) {
+    pixel = handle.r32();
+  }
+  return true;
+}
+
+static void writeThumbnail(const std::filesystem::path &path, const Thumbnail &thumbnail) {
+  uint64_t size, mtime;
+  if (!fileKey(path, size, mtime)) {
+    return;
+  }
+  Writer out;
+  out.w32(CacheVersion);
+  out.w64(size);
+  out.w64(mtime);
+  out.w16(thumbnail.width);
+  out.w16(thumbnail.height);
+  for (auto pixel : thumbnail.pixels) {
+    out.w32(pixel);
+  }
+  auto cache = cacheFile(path);
+  std::error_code ec;
+  std::filesystem::create_directories(cache.parent_path(), ec);
+  std::ofstream f(cache, std::ios::out | std::ios::binary);
+  if (!f.is_open()) {
+    return;
+  }
+  f.write(out.data.data(), out.data.length());
+}
+
+// runs on the thumbnail thread, tiles are decoded one at a time and averaged
+// into their block so we never hold more than the file itself
+bool WorldList::makeThumbnail(const std::filesystem::path &path, Thumbnail &thumbnail) {
+  auto handle = std::make_shared<Handle>(path.string());
+  WorldPreamble preamble;
+  if (!handle->isOpen() || !preamble.load(*handle)) {
+    return false;
+  }
+  WorldHeader header;
+  if (!header.decodeSection(*handle, preamble)) {
+    return false;
+  }
+  const int wide = header.tilesWide;
+  const int high = header.tilesHigh;
+  if (wide <= 0 || high <= 0) {
+    return false;
+  }
+  const int groundLevel = header.groundLevel;
+  const int rockLevel = header.rockLevel;
+  const int hellLevel = header.hellLevel();
+
+  const int scale = std::max((wide + ThumbnailWidth - 1) / ThumbnailWidth, 1);
+  thumbnail.width = (wide + scale - 1) / scale;
+  thumbnail.height = (high + scale - 1) / scale;
+  // r, g, b, count per pixel
+  std::vector<uint32_t> sums(thumbnail.width * thumbnail.height * 4);
+
+  handle->seek(preamble.sections[1]);
+  for (int x = 0; x < wide; x++) {
+    if (SDL_GetAtomicInt(&cancel)) {
+      return false;
+    }
+    uint32_t *column = sums.data() + (x / scale) * 4;
+    for (int y = 0; y < high; y++) {
+      // a truncated or corrupt world runs out before its tiles do, and
+      // other sections always follow the tiles in one that isn't
+      if (handle->tell() + Tile::MaxSize > handle->length) {
+        return false;
+      }
+      Tile tile{};
+      int rle = tile.load(handle, preamble.extra);
+      for (int end = std::min(y + rle, high - 1); y <= end; y++) {
+        uint32_t c = info.mapColor(tile, y, groundLevel, rockLevel, hellLevel);
+        uint32_t *sum = column + (y / scale) * thumbnail.width * 4;
+        sum[0] += c >> 16;
+        sum[1] += (c >> 8) & 0xff;
+        sum[2] += c & 0xff;
+        sum[3]++;
+      }
+      y--;
+    }
+  }
+
+  thumbnail.pixels.resize(thumbnail.width * thumbnail.height);
+  for (size_t i = 0; i < thumbnail.pixels.size(); i++) {
+    const uint32_t *sum = sums.data() + i * 4;
+    uint32_t n = std::max(sum[3], 1u);
+    thumbnail.pixels[i] = ((sum[0] / n) << 16) | ((sum[1] / n) << 8) | (sum[2] / n);
+  }
+  writeThumbnail(path, thumbnail);
+  return true;
+}
+
+// .net DateTime.ToBinary(), ticks since 0001-01-01 with the kind in the top bits
+static std::string formatDate(int64_t binary) {
+  const int64_t ticks = binary & 0x3fffffffffffffffLL;
+  const int64_t unixEpoch = 621355968000000000LL;
+  if (ticks <= unixEpoch) {
+    return "";
+  }
+  // summaries are made on several threads, so no gmtime and its shared buffer
+  using namespace std::chrono;
+  const sys_seconds t{seconds((ticks - unixEpoch) / 10000000)};
+  const year_month_day date{floor<days>(t)};
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u", static_cast<int>(date.year()),
+      static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()));
+  return buf;
+}
+
+WorldSummary WorldList::summarize(const std::filesystem::path &path) {
+  WorldSummary summary;
+  summary.path = path;
+  summary.scanned = true;
+  summary.title = path.filename().string();
+  WorldPreamble preamble;
+  WorldHeader header;
+  if (!header.scan(path, preamble)) {
+    summary.failed = true;
+    return summary;
+  }
+
+  summary.title = header.title;
+  summary.seed = header.seed;
+  summary.tilesWide = header.tilesWide;
+  summary.tilesHigh = header.tilesHigh;
+  summary.groundLevel = header.groundLevel;
+  summary.rockLevel = header.rockLevel;
+  if (header.tilesWide <= 4200) {
+    summary.size = "Small";
+  } else if (header.tilesWide <= 6400) {
+    summary.size = "Medium";
+  } else {
+    summary.size = "Large";
+  }
+  summary.size += " (" + std::to_string(header.tilesWide) + "x" + std::to_string(header.tilesHigh) + ")";
+  const char *modes[] = {
+    "Normal",
+    "Expert",
+    "Master",
+    "Journey",
+  };
+  summary.difficulty = header.gameMode >= 0 && header.gameMode < 4 ? modes[header.gameMode] : "Unknown";
+  if (header.hardMode) {
+    summary.difficulty += ", Hardmode";
+  }
+  summary.created = formatDate(header.creationTime);
+  summary.lastPlayed = formatDate(header.lastPlayed);
+  readThumbnail(path, summary.thumbnail);
+  return summary;
+}
@@ -0,0 +1,65 @@
+/** @copyright 2025 Sean Kasun */
+
+#pragma once
+
+#include "pool.h"
+#include "worldinfo.h"
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_mutex.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// a small map of the whole world, one 0xrrggbb pixel per block of tiles
+struct Thumbnail {
+  int width = 0, height = 0;
+  std::vector<uint32_t> pixels;
+};
+
+// what the world menu shows about a world, read from its header alone
+struct WorldSummary {
+  std::filesystem::path path;
+  bool scanned = false;
+  bool failed = false;
+  std::string title;
+  std::string seed;
+  std::string size;
+  std::string difficulty;
+  std::string created;
+  std::string lastPlayed;
+  int32_t tilesWide = 0, tilesHigh = 0;
+  // layer depths, enough to draw a rough cross section of the world
+  double groundLevel = 0.0, rockLevel = 0.0;
+  // empty until it's been generated or read from the cache
+  Thumbnail thumbnail;
+};
+
+/*
+ * The worlds in the world folders.  Headers are scanned in parallel in the
+ * background, untitled summaries are shown until they're done.
+ * Thumbnails need every tile decoded, so they're made one world at a time
+ * on a low priority thread and cached by file size and mtime.
+ */
+class WorldList {
+  public:
+    explicit WorldList(const WorldInfo &info);
+    ~WorldList();
+    void scan(const std::vector<std::filesystem::path> &folders);
+    // call every frame, adopts any summaries and thumbnails that have finished
+    void update();
+
+    std::vector<WorldSummary> worlds;
+
+  private:
+    static WorldSummary summarize(const std::filesystem::path &path);
+    bool makeThumbnail(const std::filesystem::path &path, Thumbnail &thumbnail);
+    void stop();
+
+    const WorldInfo &info;
+    Pool pool;
+    Pool thumbnails{1, SDL_THREAD_PRIORITY_LOW};
+    SDL_AtomicInt cancel{};
+    SDL_Mutex *mutex = nullptr;
+    std::vector<std::pair<size_t, WorldSummary>> finished;
+    std::vector<std::pair<size_t, Thumbnail>> finishedThumbnails;
+};